@@ -0,0 +1,65 @@
+//
+//  Fixed capacity blocking queue.
+//  Manage objects by value.
+//  Thread safe for multiple Producers and multiple Consumers.
+//  Put blocks while full, Get blocks while empty until Close.
+//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+
+template <class T>
+class BoundedQueue
+{
+public:
+    BoundedQueue(size_t capacity = 4)
+        : m_capacity(capacity > 0 ? capacity : 1), m_closed(false)
+        { }
+
+    // Wait for space, return false if queue closed.
+    bool Put(const T& value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed)
+            return false;
+        m_items.push_back(value);
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // Wait for item, return false when closed and drained.
+    bool Get(T& value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+        if (m_items.empty())
+            return false;
+        value = m_items.front();
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // No more Puts, wake all waiters.
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+private:
+    std::deque<T>           m_items;
+    size_t                  m_capacity;
+    bool                    m_closed;
+    std::mutex              m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
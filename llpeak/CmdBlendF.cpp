@@ -35,6 +35,13 @@
 #include "FileUtil.hpp"
 #include "Split.hpp"
 #include "FPrint.hpp"
+#include "TaskPool.hpp"
+#include "Progress.hpp"
+#include "RunStats.hpp"
+
+// C++
+#include <memory>
+#include <thread>
 
 
 
@@ -43,6 +50,11 @@ bool CmdBlendF::begin(StringList& fileDirList) {
     aux.verbose = true;
     aux.outCnt = 0;
     aux.outPath = output;
+    aux.sink = sink;
+    aux.indexPalette = indexed ? &imageCfg().getOutPalette() : nullptr;
+    aux.pyramidTile = pyramid;
+    aux.threads = threads;
+    aux.keepLastImg = pipedInput;
     aux.overlayImgRef = nullptr;
     aux.bottomImgRef = nullptr;
 
@@ -86,7 +98,28 @@ bool CmdBlendF::begin(StringList& fileDirList) {
         }
        
         aux.overlayMap.clear();
+        aux.lastFrame.clear();
         aux.init();
+        watchDirs = fileDirList;
+        
+        // Output, pyramid tiles and checkpoint layers would be blended back in as new frames.
+        if (watch && !DirWatch::isOutside(watchDirs, output)) {
+            std::cerr << "-watch requires -output outside the watched directories\n";
+            return false;
+        }
+        if (watch && !checkpoint.empty() && !DirWatch::isOutside(watchDirs, checkpoint)) {
+            std::cerr << "-watch requires -checkpoint outside the watched directories\n";
+            return false;
+        }
+        
+        if (resume) {
+            if (checkpoint.empty()) {
+                std::cerr << "Resume requires -checkpoint=<file>\n";
+                okay = false;
+            } else {
+                okay = ImageUtilF::LoadCheckpoint(checkpoint, aux);
+            }
+        }
     }
     
     return okay;
@@ -124,12 +157,24 @@ bool CmdBlendF::end() {
     
     bool okay = false;
     std::cout << "\nBlend" << " (" << paths.size() << ") images\n";
-    if (paths.size() == 0) {
+    if (paths.size() == 0 && !watch) {
         std::cerr << "No images to process\n";
         return false;
     }
     
     std::sort(paths.begin(), paths.end());
+    
+    if (!aux.lastFrame.empty()) {
+        // Resuming, skip frames already blended into checkpoint state.
+        auto it = std::upper_bound(paths.begin(), paths.end(), aux.lastFrame);
+        std::cout << "Resume after " << aux.lastFrame << ", skipping " << (it - paths.begin()) << " images\n";
+        paths.erase(paths.begin(), it);
+        if (paths.empty() && !watch) {
+            std::cout << "No new images since checkpoint\n";
+            aux.complete();
+            return true;
+        }
+    }
    
     if (imageCfg().valid()) {
         
@@ -141,37 +186,277 @@ bool CmdBlendF::end() {
         //     3. Threads saving images to disk [coding completed]
         // *****
         
-        for (const std::string& fullname : paths) {
-            ImageUtilF::Blend(fullname, imageCfg(), aux);
+        if (!parallel || watch || !blendChunks()) {
+            for (const std::string& fullname : paths) {
+                ImageUtilF::Blend(fullname, imageCfg(), aux);
+                Progress::frameDone();
+            }
         }
-        
-        if (aux.overlayImgRef != nullptr) {
-            // FPrint::printInfo(aux.overlayImgRef, "overlayImg");
-            okay = ImageUtilF::saveTo(aux.overlayImgRef, "/tmp/llpeak-overlay.png");
-       
+        if (watch) {
+            watchFiles();
+        }
+        okay = finish();
+    } else {
+        std::cerr << "\nMissing or invalid config file" << std::endl;
+        imageCfg().print(std::cerr);
+        aux.complete();
+    }
+    
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Frames for an overlay pixel to decay from full alpha to zero (see FImage::AdjustAlphaP32).
+static unsigned DecayFrames(float alphaMultiple) {
+    unsigned scale = (unsigned)(256 * alphaMultiple);
+    if (scale >= 256) {
+        return 0;   // Never decays.
+    }
+    unsigned frames = 0;
+    for (unsigned alpha = 255; alpha != 0; alpha = alpha * scale / 256) {
+        frames++;
+    }
+    return frames;
+}
+
+//-------------------------------------------------------------------------------------------------
+static void CopyLayer(const FImageRef& from, FImageRef& to) {
+    FImageRef imgRef(from != nullptr ? new FImage(from->Clone()) : nullptr);
+    to.swap(imgRef);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Compare overlay layers. Decayed pixels keep their color at zero alpha, blendOver never
+// reads it, so any two zero alpha pixels are equal.
+static bool SameLayer(const FImageRef& img1, const FImageRef& img2) {
+    if (img1 == nullptr || img2 == nullptr) {
+        return img1 == img2;
+    }
+    unsigned width = img1->GetWidth();
+    unsigned height = img1->GetHeight();
+    unsigned lineBytes = img1->GetBytesPerLine();
+    if (height != img2->GetHeight() || lineBytes != img2->GetBytesPerLine()) {
+        return false;
+    }
+    bool is32 = img1->GetBitsPerPixel() == 32 && img2->GetBitsPerPixel() == 32;
+    for (unsigned y = 0; y < height; y++) {
+        if (!is32) {
+            if (memcmp(img1->ReadScanLine(y), img2->ReadScanLine(y), lineBytes) != 0) {
+                return false;
+            }
+            continue;
         }
-        if (aux.bottomImgRef != nullptr) {
-            // FPrint::printInfo(aux.bottomImgRef, "bottomImg");
-            okay = ImageUtilF::saveTo(aux.bottomImgRef, "/tmp/llpeak-bottom.png");
+        const RGBQUAD* row1 = (const RGBQUAD*)img1->ReadScanLine(y);
+        const RGBQUAD* row2 = (const RGBQUAD*)img2->ReadScanLine(y);
+        for (unsigned x = 0; x < width; x++) {
+            if (row1[x].rgbReserved == 0 && row2[x].rgbReserved == 0) {
+                continue;
+            }
+            if (memcmp(&row1[x], &row2[x], sizeof(RGBQUAD)) != 0) {
+                return false;
+            }
         }
-        
-        if (aux.overlayImgRef != nullptr) {
-            const unsigned extra = 30;
-            ImageUtilF::BlendFade(paths.back(), extra, imageCfg(), aux);
-            aux.overlayImgRef->Close();
-            *aux.overlayImgRef = nullptr;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Copy Blend settings from primary aux, layers start empty.
+void CmdBlendF::initAux(ImageAux& chunkAux) const {
+    chunkAux.copySettings(aux);
+    chunkAux.doBottom = aux.doBottom;
+    chunkAux.bottomPalette = aux.bottomPalette;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Blend sorted paths in parallel chunks, return false if too few frames to split.
+//
+// Only the overlay carries state forward and it decays to zero alpha after DecayFrames,
+// so each chunk starts that many frames early and discards those warm-up outputs.
+// The bottom coverage is a running maximum, pre-computed per chunk and prefix merged.
+// A chunk whose warm-up overlay differs from the prior chunk's final overlay (pixels kept
+// alive by repeated coverage) is blended again from the true overlay, so output always
+// matches the serial blend. Frames are saved as produced, a redo saves them again under the
+// same names after the first saves complete.
+bool CmdBlendF::blendChunks() {
+    unsigned warmFrames = DecayFrames(imageCfg().overlayCfg.alphaMultiple);
+    unsigned threadCnt = TaskPool::coreCount(threads);
+    size_t chunkCnt = (warmFrames == 0) ? 0 : std::min((size_t)threadCnt, paths.size() / warmFrames);
+    if (chunkCnt < 2) {
+        std::cout << "Blend serial, overlay decays after " << warmFrames << " frames, too few frames to split\n";
+        return false;
+    }
+    
+    std::cout << "Blend " << chunkCnt << " chunks, " << warmFrames << " warm-up frames\n";
+    std::vector<size_t> firstIdx(chunkCnt + 1);
+    for (size_t chunk = 0; chunk <= chunkCnt; chunk++) {
+        firstIdx[chunk] = paths.size() * chunk / chunkCnt;
+    }
+    
+    // Chunk 0 continues primary aux (may hold resumed checkpoint state).
+    std::vector<std::unique_ptr<ImageAux>> auxList(chunkCnt);
+    std::vector<ImageAux*> chunkAux(chunkCnt, &aux);
+    for (size_t chunk = 1; chunk < chunkCnt; chunk++) {
+        auxList[chunk].reset(new ImageAux());
+        chunkAux[chunk] = auxList[chunk].get();
+        initAux(*chunkAux[chunk]);
+    }
+    
+    // Pass 1 - bottom coverage of each chunk, prefix maximum gives coverage at chunk start.
+    std::vector<FImageRef> startBottom(chunkCnt);
+    if (aux.doBottom) {
+        std::vector<ImageAux> coverAux(chunkCnt - 1);
+        TaskPool pool((unsigned)chunkCnt);
+        for (size_t chunk = 0; chunk + 1 < chunkCnt; chunk++) {
+            pool.add([&, chunk]() {
+                initAux(coverAux[chunk]);
+                for (size_t idx = firstIdx[chunk]; idx < firstIdx[chunk+1]; idx++) {
+                    ImageUtilF::BlendBottom(paths[idx], imageCfg(), coverAux[chunk]);
+                }
+            });
         }
+        pool.wait();
         
-        if (aux.bottomImgRef != nullptr) {
-            aux.bottomImgRef->Close();
-            *aux.bottomImgRef = nullptr;
+        FImageRef bottom;
+        CopyLayer(aux.bottomImgRef, bottom);
+        for (size_t chunk = 1; chunk < chunkCnt; chunk++) {
+            const FImageRef& cover = coverAux[chunk-1].bottomImgRef;
+            if (bottom == nullptr) {
+                CopyLayer(cover, bottom);
+            } else if (cover != nullptr) {
+                ImageUtilF::MaximumI8(*cover, *bottom);
+            }
+            CopyLayer(bottom, startBottom[chunk]);
+            CopyLayer(bottom, chunkAux[chunk]->bottomImgRef);
+        }
+    }
+    
+    // Pass 2 - blend chunks, warm-up frames are not saved.
+    std::vector<FImageRef> warmOverlay(chunkCnt);
+    TaskPool pool((unsigned)chunkCnt);
+    for (size_t chunk = 0; chunk < chunkCnt; chunk++) {
+        pool.add([&, chunk]() {
+            ImageAux& blendAux = *chunkAux[chunk];
+            if (chunk != 0) {
+                blendAux.sink = [](FImage&, const lstring&) { return true; };
+                size_t warmIdx = (firstIdx[chunk] > warmFrames) ? firstIdx[chunk] - warmFrames : 0;
+                for (size_t idx = warmIdx; idx < firstIdx[chunk] && !abortFlag; idx++) {
+                    ImageUtilF::Blend(paths[idx], imageCfg(), blendAux);
+                }
+                CopyLayer(blendAux.overlayImgRef, warmOverlay[chunk]);
+                blendAux.sink = aux.sink;
+            }
+            for (size_t idx = firstIdx[chunk]; idx < firstIdx[chunk+1] && !abortFlag; idx++) {
+                ImageUtilF::Blend(paths[idx], imageCfg(), blendAux);
+                Progress::frameDone();
+            }
+        });
+    }
+    pool.wait();
+    aux.complete();     // Pending saves must finish before any chunk is redone.
+    
+    // Verify warm-up reached prior chunk's overlay, else redo chunk from prior state.
+    for (size_t chunk = 1; chunk < chunkCnt && !abortFlag; chunk++) {
+        ImageAux& prevAux = *chunkAux[chunk-1];
+        ImageAux& blendAux = *chunkAux[chunk];
+        if (!SameLayer(prevAux.overlayImgRef, warmOverlay[chunk])) {
+            std::cout << "Blend chunk " << (chunk+1) << " overlay still active after warm-up, blend again\n";
+            CopyLayer(prevAux.overlayImgRef, blendAux.overlayImgRef);
+            CopyLayer(startBottom[chunk], blendAux.bottomImgRef);
+            for (size_t idx = firstIdx[chunk]; idx < firstIdx[chunk+1] && !abortFlag; idx++) {
+                ImageUtilF::Blend(paths[idx], imageCfg(), blendAux);
+            }
+            blendAux.complete();
         }
+    }
+    
+    // Primary aux takes final state for checkpoint and fade frames.
+    ImageAux& lastAux = *chunkAux[chunkCnt-1];
+    if (&lastAux != &aux) {
+        aux.overlayImgRef.swap(lastAux.overlayImgRef);
+        aux.bottomImgRef.swap(lastAux.bottomImgRef);
+        aux.lastFrame = lastAux.lastFrame;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Blend already loaded frame, skip frames already blended into resumed checkpoint.
+bool CmdBlendF::process(const lstring& fullname, FImage& img) {
+    if (!aux.lastFrame.empty() && fullname <= aux.lastFrame) {
+        return true;
+    }
+    return ImageUtilF::Blend(fullname, imageCfg(), aux, img);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Save checkpoint and layers, add fade frames after last frame.
+bool CmdBlendF::finish() {
+    bool okay = false;
+    if (aux.overlayImgRef != nullptr) {
+        // FPrint::printInfo(aux.overlayImgRef, "overlayImg");
+        okay = ImageUtilF::saveTo(aux.overlayImgRef, "/tmp/llpeak-overlay.png");
        
-    } else {
-        std::cerr << "\nMissing or invalid config file" << std::endl;
-        imageCfg().print(std::cerr);
+    }
+    if (aux.bottomImgRef != nullptr) {
+        // FPrint::printInfo(aux.bottomImgRef, "bottomImg");
+        okay = ImageUtilF::saveTo(aux.bottomImgRef, "/tmp/llpeak-bottom.png");
+    }
+    if (!checkpoint.empty()) {
+        // Save before Fade, which decays the overlay.
+        okay &= ImageUtilF::SaveCheckpoint(checkpoint, aux);
+    }
+    
+    if (aux.overlayImgRef != nullptr) {
+        const unsigned extra = 30;
+        ImageUtilF::BlendFade(aux.lastFrame, extra, imageCfg(), aux);
+        aux.overlayImgRef->Close();
+        *aux.overlayImgRef = nullptr;
+    }
+    
+    if (aux.bottomImgRef != nullptr) {
+        aux.bottomImgRef->Close();
+        *aux.bottomImgRef = nullptr;
     }
     
     aux.complete();
     return okay;
 }
+
+//-------------------------------------------------------------------------------------------------
+// Keep blend state in memory and blend new frames as they arrive, until interrupted.
+void CmdBlendF::watchFiles() {
+    DirWatch dirWatch;
+    if (!dirWatch.open(watchDirs)) {
+        return;
+    }
+    
+    // Checkpoint at most every few seconds, finish() saves the last one on exit.
+    const double checkpointSec = 10;
+    double checkpointAt = RunStats::now() + checkpointSec;
+    bool unsaved = false;
+    
+    std::cout << "Watching for new images, Ctrl-C to stop\n";
+    StringList newFiles;
+    while (!abortFlag) {
+        if (dirWatch.next(newFiles, 250)) {
+            paths.clear();
+            for (const lstring& fullname : newFiles) {
+                add(fullname, IS_FILE);
+            }
+            std::sort(paths.begin(), paths.end());
+            for (const lstring& fullname : paths) {
+                if (ImageUtilF::Blend(fullname, imageCfg(), aux)) {
+                    Progress::frameDone();
+                    std::cout << "Blend " << fullname << std::endl;
+                    unsaved = true;
+                }
+            }
+        }
+        if (unsaved && !checkpoint.empty() && RunStats::now() >= checkpointAt) {
+            ImageUtilF::SaveCheckpoint(checkpoint, aux);
+            checkpointAt = RunStats::now() + checkpointSec;
+            unsaved = false;
+        }
+    }
+}
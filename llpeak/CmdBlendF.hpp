@@ -33,11 +33,13 @@
 #pragma once
 
 #include "Command.hpp"
+#include "DirWatch.hpp"
 
 
 class CmdBlendF : public Command {
     ImageAux aux;
     StringList paths;
+    StringList watchDirs;
  
 public:
     CmdBlendF(ImageCfgRef cfg) : Command("blendF", cfg) {}
@@ -45,6 +47,17 @@ public:
     bool begin(StringList& fileDirList);
     size_t add(const lstring& file, DIR_TYPES dtype);
     bool end();
+    
+    bool sharesFrames() const {
+        return true;
+    }
+    bool process(const lstring& file, FImage& img);
+    bool finish();
+    
+private:
+    void watchFiles();
+    bool blendChunks();
+    void initAux(ImageAux& chunkAux) const;
 };
 
 
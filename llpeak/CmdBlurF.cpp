@@ -35,6 +35,7 @@
 #include "CmdBlurF.hpp"
 #include "Directory.hpp"
 #include "FileUtil.hpp"
+#include "Progress.hpp"
 
 //-------------------------------------------------------------------------------------------------
 bool CmdBlurF::begin(StringList& fileDirList) {
@@ -44,6 +45,7 @@ bool CmdBlurF::begin(StringList& fileDirList) {
     
     aux.verbose = verbose;
     aux.outPath = output;
+    aux.sink = sink;
     aux.shadeMap.clear();
     aux.init();
     return fileDirList.size() > 0 && imageCfg().valid();
@@ -70,7 +72,7 @@ size_t CmdBlurF::add(const lstring& fullname, DIR_TYPES dtype) {
                 std::cout << "ReadOnly " << fullname.c_str() << std::endl;
         }
 
-        ImageUtilF::Blur(fullname, imageCfg(), aux);
+        paths.push_back(fullname);
     }
 
     return fileCount;
@@ -78,6 +80,23 @@ size_t CmdBlurF::add(const lstring& fullname, DIR_TYPES dtype) {
 
 //-------------------------------------------------------------------------------------------------
 bool CmdBlurF::end() {
+    bool okay = true;
+    for (const std::string& fullname : paths) {
+        okay &= ImageUtilF::Blur(fullname, imageCfg(), aux);
+        Progress::frameDone();
+    }
+    aux.complete();
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Blur already loaded image.
+bool CmdBlurF::process(const lstring& fullname, FImage& img) {
+    return ImageUtilF::Blur(fullname, imageCfg(), aux, img);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CmdBlurF::finish() {
     aux.complete();
     return true;
 }
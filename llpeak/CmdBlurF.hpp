@@ -39,6 +39,7 @@
 //-------------------------------------------------------------------------------------------------
 class CmdBlurF : public Command {
     ImageAux aux;
+    StringList paths;
     
 public:
     CmdBlurF( ImageCfgRef cfg) : Command("blurF", cfg) {}
@@ -46,5 +47,11 @@ public:
     bool begin(StringList& fileDirList);
     size_t add(const lstring& file, DIR_TYPES dtype);
     bool end();
+    
+    bool sharesFrames() const {
+        return true;
+    }
+    bool process(const lstring& file, FImage& img);
+    bool finish();
 };
 
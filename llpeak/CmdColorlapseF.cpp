@@ -35,6 +35,7 @@
 #include "FileUtil.hpp"
 #include "Split.hpp"
 #include "FPrint.hpp"
+#include "Progress.hpp"
 
 
 
@@ -43,6 +44,9 @@ bool CmdColorlapseF::begin(StringList& fileDirList) {
     aux.verbose = true;
     aux.outCnt = 0;
     aux.outPath = output;
+    aux.sink = sink;
+    aux.indexPalette = indexed ? &imageCfg().getOutPalette() : nullptr;
+    aux.threads = threads;
     aux.overlayImgRef = nullptr;
     aux.bottomImgRef = nullptr;
 
@@ -97,6 +101,7 @@ bool CmdColorlapseF::end() {
     if (imageCfg().valid()) {
         for (const std::string& fullname : paths) {
             ImageUtilF::Colorlapse(fullname, imageCfg(), aux);
+            Progress::frameDone();
         }
     } else {
         std::cerr << "\nMissing or invalid config file" << std::endl;
@@ -106,3 +111,15 @@ bool CmdColorlapseF::end() {
     aux.complete();
     return okay;
 }
+
+//-------------------------------------------------------------------------------------------------
+// Colorlapse already loaded image.
+bool CmdColorlapseF::process(const lstring& fullname, FImage& img) {
+    return ImageUtilF::Colorlapse(fullname, imageCfg(), aux, img);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CmdColorlapseF::finish() {
+    aux.complete();
+    return true;
+}
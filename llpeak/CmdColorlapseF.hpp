@@ -45,6 +45,12 @@ public:
     bool begin(StringList& fileDirList);
     size_t add(const lstring& file, DIR_TYPES dtype);
     bool end();
+    
+    bool sharesFrames() const {
+        return true;
+    }
+    bool process(const lstring& file, FImage& img);
+    bool finish();
 };
 
 
@@ -35,6 +35,7 @@
 #include "CmdDumpF.hpp"
 #include "Directory.hpp"
 #include "FileUtil.hpp"
+#include "Progress.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -62,7 +63,8 @@ size_t CmdDumpF::add(const lstring& fullname, DIR_TYPES dtype) {
         // TODO - add options to get tabular report of image properties, similar to ImageMagick "identify"
         // *****
         ImageUtilF::Dump(fullname);
-        ImageUtilF::Palette(fullname);
+        ImageUtilF::Palette(fullname, output);
+        Progress::frameDone();
     }
 
     return fileCount;
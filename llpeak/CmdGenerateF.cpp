@@ -0,0 +1,96 @@
+//-------------------------------------------------------------------------------------------------
+// File: CmdGenerateF.cpp
+// Desc: Generate synthetic radar image sequence
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "CmdGenerateF.hpp"
+#include "FileUtil.hpp"
+#include "Progress.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Parse <width>x<height>,<frames>[,<coverage>[,<bits>]]  ex 1024x720,200,0.3,32
+bool CmdGenerateF::begin(StringList& /* fileDirList */) {
+    if (!imageCfg().isValid) {
+        std::cerr << "Missing or invalid config file, use -config <cfg.json>\n";
+        return false;
+    }
+    
+    const char errMsg[] = "Missing or poorly formed generate command, expects WxH,frames[,coverage[,bits]], ex 1024x720,200,0.3 not ";
+    
+    char* nextPtr;
+    const char* ptr = cmdValue;
+    long width = strtol(ptr, &nextPtr, 10);
+    long height = (*nextPtr == 'x' || *nextPtr == 'X') ? strtol(ptr = nextPtr + 1, &nextPtr, 10) : 0;
+    long frames = (*nextPtr == ',' && nextPtr != ptr) ? strtol(ptr = nextPtr + 1, &nextPtr, 10) : 0;
+    if (width <= 0 || height <= 0 || frames <= 0 || nextPtr == ptr) {
+        std::cerr << errMsg << cmdValue << std::endl;
+        return false;
+    }
+    options.width = (unsigned)width;
+    options.height = (unsigned)height;
+    options.frames = (unsigned)frames;
+    
+    if (*nextPtr == ',') {
+        options.coverage = strtof(ptr = nextPtr + 1, &nextPtr);
+        if (nextPtr == ptr || options.coverage < 0 || options.coverage > 1) {
+            std::cerr << "Generate coverage must be 0 to 1, not " << cmdValue << std::endl;
+            return false;
+        }
+    }
+    if (*nextPtr == ',') {
+        options.bits = (unsigned)strtol(ptr = nextPtr + 1, &nextPtr, 10);
+        if (options.bits != 8 && options.bits != 32) {
+            std::cerr << "Generate bits must be 8 or 32, not " << cmdValue << std::endl;
+            return false;
+        }
+    }
+    if (*nextPtr != '\0') {
+        std::cerr << errMsg << cmdValue << std::endl;
+        return false;
+    }
+    return true;    // No input files needed
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t CmdGenerateF::add(const lstring& /* fullname */, DIR_TYPES /* dtype */) {
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CmdGenerateF::end() {
+    const FPalette& inPalette = imageCfg().getInPalette();
+    const FPalette& palette = inPalette.empty() ? imageCfg().getOutPalette() : inPalette;
+    
+    Progress::setTotal(options.frames);
+    return FGenerate::Save(palette, options, output, threads);
+}
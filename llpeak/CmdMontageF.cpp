@@ -110,7 +110,7 @@ bool CmdMontageF::end() {
     if (imageCfg().isValid) {
         inPalette = imageCfg().getInPalette();
     }
-    okay |= ImageUtilF::Montage(inPalette, paths, xTiles, yTiles, output);
+    okay |= ImageUtilF::Montage(inPalette, paths, xTiles, yTiles, output, threads, pyramid);
 
     return okay;
 }
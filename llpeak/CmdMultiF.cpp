@@ -0,0 +1,124 @@
+//-------------------------------------------------------------------------------------------------
+// File: CmdMultiF.cpp
+// Desc: Execute several "-config" jobs over one pass of decoded frames.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Project files
+#include "CmdMultiF.hpp"
+#include "FileUtil.hpp"
+#include "Progress.hpp"
+#include "TaskPool.hpp"
+
+// C++
+#include <set>
+
+
+//-------------------------------------------------------------------------------------------------
+bool CmdMultiF::begin(StringList& fileDirList) {
+    bool okay = true;
+    std::set<lstring> outputs;
+    for (unsigned idx = 0; idx < jobs.size(); idx++) {
+        Command* job = jobs[idx];
+        if (!job->sharesFrames()) {
+            std::cerr << "Job " << (idx+1) << " command can not be combined with other -config jobs\n";
+            okay = false;
+        } else if (!outputs.insert(job->output).second) {
+            std::cerr << "Job " << (idx+1) << " must have its own -output path\n";
+            okay = false;
+        } else {
+            okay &= job->begin(fileDirList);
+        }
+    }
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Offer file to each job, remember which jobs will use it.
+size_t CmdMultiF::add(const lstring& fullname, DIR_TYPES dtype) {
+    size_t fileCount = 0;
+    for (Command* job : jobs) {
+        if (job->add(fullname, dtype) != 0) {
+            frames[fullname].push_back(job);
+            fileCount = 1;
+        }
+    }
+    return fileCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Decode each frame once and run the jobs using it as TaskPool tasks, each on its own copy.
+bool CmdMultiF::end() {
+    std::cout << "\nJobs " << jobs.size() << " (" << frames.size() << ") images\n";
+    if (frames.empty()) {
+        std::cerr << "No images to process\n";
+        return false;
+    }
+    
+    bool okay = true;
+    TaskPool pool((unsigned)jobs.size());
+    for (auto& frame : frames) {
+        if (abortFlag) {
+            break;
+        }
+        const lstring& fullname = frame.first;
+        std::vector<Command*>& frameJobs = frame.second;
+        
+        FImage img;
+        if (!ImageUtilF::LoadImage(img, fullname).Valid()) {
+            okay = false;
+            continue;
+        }
+        
+        // Jobs modify their image (palette, pixels), first job gets the decoded image.
+        std::vector<FImage> jobImgs(frameJobs.size());
+        for (unsigned idx = 1; idx < frameJobs.size(); idx++) {
+            jobImgs[idx] = img.Clone();
+        }
+        jobImgs[0] = img;
+        
+        std::vector<char> results(frameJobs.size(), true);
+        for (unsigned idx = 0; idx < frameJobs.size(); idx++) {
+            pool.add([&, idx]() {
+                results[idx] = frameJobs[idx]->process(fullname, jobImgs[idx]);
+            });
+        }
+        pool.wait();
+        for (unsigned idx = 0; idx < frameJobs.size(); idx++) {
+            okay &= results[idx] != 0;
+            jobImgs[idx].Close();
+        }
+        Progress::frameDone();
+    }
+    
+    for (Command* job : jobs) {
+        okay &= job->finish();
+    }
+    return okay;
+}
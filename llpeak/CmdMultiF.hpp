@@ -0,0 +1,55 @@
+//-------------------------------------------------------------------------------------------------
+// File: CmdMultiF.hpp
+// Desc: Execute several "-config" jobs over one pass of decoded frames.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "Command.hpp"
+
+// C++
+#include <map>
+
+
+class CmdMultiF : public Command {
+    std::vector<Command*> jobs;
+    std::map<lstring, std::vector<Command*>> frames;   // Sorted frames and jobs using them
+ 
+public:
+    CmdMultiF(ImageCfgRef cfg) : Command("multiF", cfg) {}
+    
+    void addJob(Command* job) {
+        jobs.push_back(job);
+    }
+    
+    bool begin(StringList& fileDirList);
+    size_t add(const lstring& file, DIR_TYPES dtype);
+    bool end();
+};
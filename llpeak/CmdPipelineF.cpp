@@ -0,0 +1,151 @@
+//-------------------------------------------------------------------------------------------------
+// File: CmdPipelineF.cpp
+// Desc: Run commands as in-memory stages, each stage output feeds next stage.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "CmdPipelineF.hpp"
+#include "FileUtil.hpp"
+#include "Progress.hpp"
+
+// C++
+#include <algorithm>
+#include <thread>
+
+static const size_t PIPE_DEPTH = 4;     // Frames waiting between stages
+
+
+//-------------------------------------------------------------------------------------------------
+bool CmdPipelineF::begin(StringList& fileDirList) {
+    if (stages.empty()) {
+        std::cerr << "Pipeline has no stages, use -pipeline=blur,shade2,...\n";
+        return false;
+    }
+    
+    bool okay = true;
+    queues.clear();
+    for (unsigned idx = 0; idx < stages.size(); idx++) {
+        Command* stage = stages[idx];
+        if (!stage->sharesFrames()) {
+            std::cerr << "Pipeline stage " << (idx+1) << " can not be used in a pipeline\n";
+            okay = false;
+            continue;
+        }
+        
+        ImageSink stageSink;
+        if (idx + 1 < stages.size()) {
+            queues.emplace_back(new FrameQueue(PIPE_DEPTH));
+            FrameQueue* queue = queues.back().get();
+            stageSink = [queue](FImage& img, const lstring& name) {
+                return queue->Put(Frame(name, img));
+            };
+        }
+        
+        stage->share(*this);
+        stage->sink = stageSink;
+        stage->pipedInput = (idx != 0);
+        okay &= stage->begin(fileDirList);
+    }
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// First stage decides which files are used.
+size_t CmdPipelineF::add(const lstring& fullname, DIR_TYPES dtype) {
+    if (!stages.empty() && stages[0]->add(fullname, dtype) != 0) {
+        paths.push_back(fullname);
+        return 1;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Stage 0 decodes input files, other stages consume previous stage output.
+// Closing a stage's output queue lets the next stage finish.
+bool CmdPipelineF::runStage(unsigned stageIdx) {
+    Command* stage = stages[stageIdx];
+    bool okay = true;
+    
+    if (stageIdx == 0) {
+        for (const lstring& fullname : paths) {
+            if (abortFlag) {
+                break;
+            }
+            FImage img;
+            if (ImageUtilF::LoadImage(img, fullname).Valid()) {
+                okay &= stage->process(fullname, img);
+            } else {
+                okay = false;
+            }
+            if (stages.size() == 1)
+                Progress::frameDone();
+        }
+    } else {
+        Frame frame;
+        while (queues[stageIdx-1]->Get(frame)) {
+            okay &= stage->process(frame.first, frame.second);
+            frame.second.Close();
+            if (stageIdx + 1 == stages.size())
+                Progress::frameDone();
+        }
+    }
+    
+    okay &= stage->finish();
+    if (stageIdx < queues.size()) {
+        queues[stageIdx]->Close();
+    }
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CmdPipelineF::end() {
+    std::cout << "\nPipeline " << stages.size() << " stages (" << paths.size() << ") images\n";
+    if (paths.empty()) {
+        std::cerr << "No images to process\n";
+        return false;
+    }
+    
+    std::sort(paths.begin(), paths.end());
+    std::vector<std::thread> threads;
+    std::vector<char> results(stages.size(), true);
+    for (unsigned idx = 0; idx < stages.size(); idx++) {
+        threads.push_back(std::thread([this, &results, idx]() {
+            results[idx] = runStage(idx);
+        }));
+    }
+    
+    bool okay = true;
+    for (unsigned idx = 0; idx < threads.size(); idx++) {
+        threads[idx].join();
+        okay &= results[idx] != 0;
+    }
+    return okay;
+}
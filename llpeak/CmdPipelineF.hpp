@@ -0,0 +1,64 @@
+//-------------------------------------------------------------------------------------------------
+// File: CmdPipelineF.hpp
+// Desc: Run commands as in-memory stages, each stage output feeds next stage.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include "Command.hpp"
+#include "BoundedQueue.hpp"
+
+// C++
+#include <memory>
+
+
+class CmdPipelineF : public Command {
+    typedef std::pair<lstring, FImage> Frame;
+    typedef BoundedQueue<Frame> FrameQueue;
+    
+    std::vector<Command*> stages;
+    std::vector<std::unique_ptr<FrameQueue>> queues;    // queues[i] feeds stages[i+1]
+    StringList paths;
+ 
+public:
+    CmdPipelineF(ImageCfgRef cfg) : Command("pipelineF", cfg) {}
+    
+    void addStage(Command* stage) {
+        stages.push_back(stage);
+    }
+    
+    bool begin(StringList& fileDirList);
+    size_t add(const lstring& file, DIR_TYPES dtype);
+    bool end();
+    
+private:
+    bool runStage(unsigned stageIdx);
+};
@@ -35,6 +35,7 @@
 #include "Directory.hpp"
 #include "FPrint.hpp"
 #include "FileUtil.hpp"
+#include "Progress.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -45,7 +46,13 @@ bool CmdShadeF::begin(StringList& fileDirList) {
     
     aux.verbose = verbose;
     aux.outPath = output;
+    aux.sink = sink;
     aux.shadeMap.clear();
+    watchDirs = fileDirList;
+    if (watch && !DirWatch::isOutside(watchDirs, output)) {
+        std::cerr << "-watch requires -output outside the watched directories\n";
+        return false;
+    }
     return fileDirList.size() > 0 && imageCfg().valid();
 }
 
@@ -80,7 +87,7 @@ bool CmdShadeF::end() {
     bool okay = true;
 
     std::cout << "\n" << aux.shadeRef->getName() << " (" << paths.size() << ") images\n";
-    if (paths.size() == 0) {
+    if (paths.size() == 0 && !watch) {
         std::cerr << "No images to process\n";
         return false;
     }
@@ -92,7 +99,52 @@ bool CmdShadeF::end() {
             std::cerr << "Shade failed/skipped on " << fullname << std::endl;
             okay = false;
         }
+        Progress::frameDone();
+    }
+    if (watch) {
+        watchFiles();
     }
 
     return okay;
 }
+
+//-------------------------------------------------------------------------------------------------
+// Shade already loaded image.
+bool CmdShadeF::process(const lstring& fullname, FImage& img) {
+    return ImageUtilF::Shade(fullname, imageCfg(), aux, img);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CmdShadeF::finish() {
+    aux.complete();
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Keep shade mapping in memory and shade new images as they arrive, until interrupted.
+void CmdShadeF::watchFiles() {
+    DirWatch dirWatch;
+    if (!dirWatch.open(watchDirs)) {
+        return;
+    }
+    
+    std::cout << "Watching for new images, Ctrl-C to stop\n";
+    StringList newFiles;
+    while (!abortFlag) {
+        if (dirWatch.next(newFiles, 250)) {
+            paths.clear();
+            for (const lstring& fullname : newFiles) {
+                add(fullname, IS_FILE);
+            }
+            std::sort(paths.begin(), paths.end());
+            for (const lstring& fullname : paths) {
+                if (ImageUtilF::Shade(fullname, imageCfg(), aux)) {
+                    Progress::frameDone();
+                    std::cout << "Shade " << fullname << std::endl;
+                } else {
+                    std::cerr << "Shade failed/skipped on " << fullname << std::endl;
+                }
+            }
+        }
+    }
+}
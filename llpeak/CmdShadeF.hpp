@@ -33,11 +33,13 @@
 #pragma once
 
 #include "Command.hpp"
+#include "DirWatch.hpp"
 
 
 class CmdShadeF : public Command {
     ImageAux aux;
     StringList paths;
+    StringList watchDirs;
     
 public:
     CmdShadeF( ImageCfgRef cfg) : Command("shadeF", cfg) {}
@@ -46,7 +48,16 @@ public:
     size_t add(const lstring& file, DIR_TYPES dtype);
     bool end();
     
+    bool sharesFrames() const {
+        return true;
+    }
+    bool process(const lstring& file, FImage& img);
+    bool finish();
+    
     ImageAux& getAux() {
         return aux;
     }
+    
+private:
+    void watchFiles();
 };
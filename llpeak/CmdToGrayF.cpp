@@ -35,6 +35,7 @@
 #include "Directory.hpp"
 #include "FPrint.hpp"
 #include "FileUtil.hpp"
+#include "Progress.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -43,6 +44,8 @@ bool CmdToGrayF::begin(StringList& fileDirList) {
         std::cerr << "Missing or invalid config file, use -config <cfg.json>\n";
     }
     
+    aux.outPath = output;
+    aux.sink = sink;
     aux.init();
     return fileDirList.size() > 0; //  && imageCfg().valid();
 }
@@ -90,6 +93,7 @@ bool CmdToGrayF::end() {
             if (!ImageUtilF::ToGray(fullname, imageCfg(), aux)) {
                 std::cerr << fullname << " Failed to convert to gray\n";
             }
+            Progress::frameDone();
         }
     } else {
         std::cerr << "\nMissing or invalid config file" << std::endl;
@@ -100,3 +104,15 @@ bool CmdToGrayF::end() {
 
     return okay;
 }
+
+//-------------------------------------------------------------------------------------------------
+// Convert already loaded image.
+bool CmdToGrayF::process(const lstring& fullname, FImage& img) {
+    return ImageUtilF::ToGray(fullname, imageCfg(), aux, img);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool CmdToGrayF::finish() {
+    aux.complete();
+    return true;
+}
@@ -60,6 +60,15 @@ public:
     PatternList excludeFilePatList;
     lstring output;
     lstring cmdValue;
+    lstring checkpoint;         // Save/restore accumulated state file
+    bool resume = false;        // Continue from checkpoint state
+    bool watch = false;         // Keep state, process new files as they arrive
+    bool parallel = false;      // Split work across threads when order allows
+    unsigned threads = 0;       // Max worker threads, 0 = all cores
+    bool indexed = false;       // Save 8bit palette images when output is 32bit
+    unsigned pyramid = 0;       // Also save z/x/y tile pyramid, tile size, 0 = none
+    ImageSink sink;             // Pipeline, pass output images to next stage (see CmdPipelineF)
+    bool pipedInput = false;    // Pipeline, input images passed in memory, not on disk
     
     bool showFile = false;
     bool verbose = false;
@@ -81,12 +90,30 @@ public:
     virtual bool end() {
         return true;
     }
+    
+    // Frame sharing between several -config jobs (see CmdMultiF), image already decoded.
+    virtual bool sharesFrames() const {
+        return false;
+    }
+    virtual bool process(const lstring& /* file */, FImage& /* img */) {
+        return false;
+    }
+    virtual bool finish() {
+        return true;
+    }
 
     Command& share(const Command& other) {
         includeFilePatList = other.includeFilePatList;
         excludeFilePatList = other.excludeFilePatList;
         output = other.output;
         cmdValue = other.cmdValue;
+        checkpoint = other.checkpoint;
+        resume = other.resume;
+        watch = other.watch;
+        parallel = other.parallel;
+        threads = other.threads;
+        indexed = other.indexed;
+        pyramid = other.pyramid;
         
         showFile = other.showFile;
         verbose = other.verbose;
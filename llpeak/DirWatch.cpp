@@ -0,0 +1,273 @@
+//-------------------------------------------------------------------------------------------------
+// File: DirWatch.cpp
+// Desc: Watch directories for newly arrived files.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Project files
+#include "DirWatch.hpp"
+
+// C++
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+// C
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#if defined(HAVE_WIN) && !defined(S_ISDIR)
+#define S_ISDIR(m) (((m)&S_IFMT) == S_IFDIR)
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+// Absolute directory with trailing slash, missing trailing parts are kept as given.
+static lstring FullDir(const lstring& dirname) {
+    lstring baseDir = dirname;
+    lstring missing;
+    while (!baseDir.empty() && (baseDir.back() == '/' || baseDir.back() == '\\')) {
+        baseDir.pop_back();
+    }
+    
+    lstring fullDir;
+    for (;;) {
+#ifdef HAVE_WIN
+        char realDir[_MAX_PATH];
+        const char* found = _fullpath(realDir, baseDir.empty() ? "." : baseDir.c_str(), sizeof(realDir));
+#else
+        char realDir[PATH_MAX];
+        const char* found = realpath(baseDir.empty() ? "." : baseDir.c_str(), realDir);
+#endif
+        if (found != nullptr) {
+            fullDir = realDir;
+            break;
+        }
+        size_t slashPos = baseDir.find_last_of("/\\");
+        if (slashPos == std::string::npos) {
+            missing = baseDir + Directory_files::SLASH + missing;
+            baseDir.clear();
+        } else {
+            missing = baseDir.substr(slashPos + 1) + Directory_files::SLASH + missing;
+            baseDir.erase(slashPos);
+            if (baseDir.empty()) {
+                fullDir = Directory_files::SLASH;
+                break;
+            }
+        }
+    }
+    
+    if (fullDir.back() != '/' && fullDir.back() != '\\') {
+        fullDir += Directory_files::SLASH;
+    }
+    return fullDir + missing;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool DirWatch::isOutside(const StringList& dirList, const lstring& outPath) {
+    size_t slashPos = outPath.find_last_of("/\\");
+    lstring outDir = (slashPos == std::string::npos) ? "." : outPath.substr(0, slashPos + 1);
+    outDir = FullDir(outDir);
+    for (const lstring& dirname : dirList) {
+        lstring watchDir = FullDir(dirname);
+        if (outDir.compare(0, watchDir.length(), watchDir) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Start watching directories, files are ignored.
+bool DirWatch::open(const StringList& dirList) {
+    close();
+#ifdef __linux__
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd < 0) {
+        std::cerr << strerror(errno) << ", Failed to start directory watch\n";
+        return false;
+    }
+#endif
+    for (const lstring& dirname : dirList) {
+        struct stat filestat;
+        if (stat(dirname, &filestat) == 0 && S_ISDIR(filestat.st_mode)) {
+            addDir(dirname);
+        }
+    }
+    
+#ifndef __linux__
+    StringList ignore;
+    scan(ignore, true);
+#endif
+    if (dirs.empty()) {
+        std::cerr << "Watch requires at least one directory\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void DirWatch::close() {
+    dirs.clear();
+#ifdef __linux__
+    if (notifyFd >= 0) {
+        ::close(notifyFd);
+        notifyFd = -1;
+    }
+    watchDirs.clear();
+#else
+    files.clear();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+// Add directory and recurse into sub-directories, optionally collect files already present.
+void DirWatch::addDir(const lstring& dirname, StringList* existing) {
+    lstring fullDir = dirname;
+#ifdef __linux__
+    char realDir[PATH_MAX];
+    if (realpath(dirname, realDir) != nullptr) {
+        fullDir = realDir;
+    }
+    int wd = inotify_add_watch(notifyFd, fullDir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+        std::cerr << strerror(errno) << ", Failed to watch " << fullDir << std::endl;
+        return;
+    }
+    watchDirs[wd] = fullDir;
+#endif
+    dirs.push_back(fullDir);
+    
+    Directory_files directory(fullDir);
+    lstring fullname;
+    while (directory.more()) {
+        directory.fullName(fullname);
+        if (directory.is_directory()) {
+            addDir(fullname, existing);
+        } else if (existing != nullptr) {
+            existing->push_back(fullname);
+        }
+    }
+}
+
+#ifdef __linux__
+//-------------------------------------------------------------------------------------------------
+// Wait for inotify events, collect files which were closed after writing or moved into place.
+// New sub-directories are watched, files of a directory moved in are reported. Files of a
+// created directory arrive as their own close events.
+bool DirWatch::next(StringList& newFiles, unsigned waitMsec) {
+    newFiles.clear();
+    struct pollfd pfd;
+    pfd.fd = notifyFd;
+    pfd.events = POLLIN;
+    if (notifyFd < 0 || poll(&pfd, 1, (int)waitMsec) <= 0) {
+        return false;
+    }
+
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t len;
+    while ((len = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event* event = (const struct inotify_event*)ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+            auto it = watchDirs.find(event->wd);
+            if (event->len == 0 || it == watchDirs.end()) {
+                continue;
+            }
+            lstring fullname;
+            DirUtil::join(fullname, it->second, event->name);
+            if ((event->mask & IN_ISDIR) != 0) {
+                addDir(fullname, (event->mask & IN_MOVED_TO) != 0 ? &newFiles : nullptr);
+            } else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0) {
+                newFiles.push_back(fullname);
+            }
+        }
+    }
+    return !newFiles.empty();
+}
+
+#else
+//-------------------------------------------------------------------------------------------------
+// Scan directories, report files whose size and time are unchanged for two scans.
+// New sub-directories are appended to dirs and scanned in the same pass.
+void DirWatch::scan(StringList& newFiles, bool initial) {
+    for (size_t dirIdx = 0; dirIdx < dirs.size(); dirIdx++) {
+        Directory_files directory(dirs[dirIdx]);
+        lstring fullname;
+        while (directory.more()) {
+            directory.fullName(fullname);
+            if (directory.is_directory()) {
+                if (std::find(dirs.begin(), dirs.end(), fullname) == dirs.end()) {
+                    dirs.push_back(fullname);
+                }
+                continue;
+            }
+            struct stat filestat;
+            if (stat(fullname, &filestat) != 0) {
+                continue;
+            }
+            auto it = files.find(fullname);
+            if (it == files.end()) {
+                FileState state = { (size_t)filestat.st_size, filestat.st_mtime, initial, 0 };
+                files[fullname] = state;
+            } else {
+                FileState& state = it->second;
+                bool stable = state.size == (size_t)filestat.st_size && state.modTime == filestat.st_mtime;
+                state.stableScans = stable ? state.stableScans + 1 : 0;
+                if (state.stableScans >= 2 && !state.reported) {
+                    state.reported = true;
+                    newFiles.push_back(fullname);
+                }
+                state.size = (size_t)filestat.st_size;
+                state.modTime = filestat.st_mtime;
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Poll directories for new files which have finished arriving.
+bool DirWatch::next(StringList& newFiles, unsigned waitMsec) {
+    newFiles.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(waitMsec));
+    scan(newFiles, false);
+    return !newFiles.empty();
+}
+#endif
@@ -0,0 +1,85 @@
+//-------------------------------------------------------------------------------------------------
+// File: DirWatch.hpp
+// Desc: Watch directories for newly arrived files.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+// Project files
+#include "Directory.hpp"
+
+// C++
+#include <map>
+#include <vector>
+
+typedef std::vector<lstring> StringList;
+
+//-------------------------------------------------------------------------------------------------
+// Report files which finish arriving in a set of directories.
+// Linux uses inotify (close-after-write and rename-into events), other platforms poll and
+// report a file once its size and time are unchanged for two scans (mtime may be 1 sec).
+// Sub-directories created or moved in after open() are watched too.
+class DirWatch {
+public:
+    DirWatch()
+    { }
+    ~DirWatch() {
+        close();
+    }
+
+    // Start watching directories (and their sub-directories), files already present are ignored.
+    bool open(const StringList& dirList);
+    void close();
+
+    // Wait up to waitMsec for new files, return true if any added to newFiles (full paths).
+    bool next(StringList& newFiles, unsigned waitMsec);
+
+    // True if files written to outPath (directory or directory plus name prefix) land outside
+    // every directory tree in dirList, so the watch does not pick up its own output.
+    static bool isOutside(const StringList& dirList, const lstring& outPath);
+
+private:
+    void addDir(const lstring& dirname, StringList* existing = nullptr);
+
+    StringList dirs;
+#ifdef __linux__
+    int notifyFd = -1;
+    std::map<int, lstring> watchDirs;   // watch descriptor to directory
+#else
+    struct FileState {
+        size_t   size;
+        time_t   modTime;
+        bool     reported;
+        unsigned stableScans;   // Scans with size and time unchanged
+    };
+    std::map<lstring, FileState> files;
+    void scan(StringList& newFiles, bool initial);
+#endif
+};
@@ -41,11 +41,16 @@
 
 // Project files
 #include "FBlur.hpp"
+#include "ImageAux.hpp"
+#include "TaskPool.hpp"
+
+// C++
+#include <algorithm>
 
 //-------------------------------------------------------------------------------------------------
-void FBlur::toFloat( const PalMapping& mapping, const FImage& inI8, unsigned width, unsigned height, float* grid) {
-    
-    for (unsigned y = 0; y < height; y++) {
+void FBlur::toFloat( const PalMapping& mapping, const FImage& inI8, unsigned width, unsigned height, float* grid, unsigned yBeg) {
+    grid += (size_t)yBeg * width;
+    for (unsigned y = yBeg; y < height; y++) {
         const BYTE* inPx = inI8.ReadScanLine(y);
         for (unsigned x = 0; x < width; x++) {
             unsigned px = mapping.to[inPx[x]];
@@ -114,11 +119,12 @@ void FBlur::hBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* in
 }
 
 //-------------------------------------------------------------------------------------------------
-void FBlur::vBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* inGrid, float* outGrid) {
+void FBlur::vBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* inGrid, float* outGrid, unsigned xBeg, unsigned xEnd) {
     unsigned numSamples = radius * 2 + 1;
     float invN = 1.0f / numSamples;
     
-    for (unsigned x = 0; x < xDim; x++) {
+    xEnd = std::min(xEnd, xDim);
+    for (unsigned x = xBeg; x < xEnd; x++) {
         const float* head = inGrid + x;
         const float* tail = head;
         float* pOut = outGrid + x;
@@ -180,9 +186,10 @@ void FBlur::vBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* in
 }
 
 //-------------------------------------------------------------------------------------------------
-void FBlur::toPixel32(const float* inGrid, const FPalette& inPalette, unsigned width, unsigned height, FImage& outP32) {
+void FBlur::toPixel32(const float* inGrid, const FPalette& inPalette, unsigned width, unsigned height, FImage& outP32, unsigned yBeg) {
     const unsigned nColors = (unsigned)inPalette.size();
-    for (unsigned y = 0; y < height; y++) {
+    inGrid += (size_t)yBeg * width;
+    for (unsigned y = yBeg; y < height; y++) {
         FColor* outRow = (FColor*)outP32.ScanLine(y);
         for (unsigned x = 0; x < width; x++) {
             float fp = *inGrid++;
@@ -211,11 +218,33 @@ bool FBlur::blurI8(
     unique_ptr<float> inGrid(new float[width*height]);
     unique_ptr<float> outGrid(new float[width*height]);
     
-    toFloat(mapping, inI8, width, height, inGrid.get());
-    hBlur(radius, width, height, inGrid.get(), outGrid.get());
-    outGrid.swap(inGrid);
-    vBlur(radius, width, height, inGrid.get(), outGrid.get());
-    toPixel32(outGrid.get(), outPalette, width, height, outP32);
+    // Row bands (column bands for vBlur) run on the shared scheduler, output matches serial.
+    TaskPool pool(aux.threads);
+    const unsigned bands = std::max(1u, std::min(pool.size() * 4, std::min(width, height)));
+    float* inPtr = inGrid.get();
+    float* outPtr = outGrid.get();
+    
+    for (unsigned band = 0; band < bands; band++) {
+        pool.add([&, band]() {
+            unsigned yBeg = band * height / bands;
+            unsigned yEnd = (band + 1) * height / bands;
+            toFloat(mapping, inI8, width, yEnd, inPtr, yBeg);
+            hBlur(radius, width, yEnd - yBeg, inPtr + (size_t)yBeg * width, outPtr + (size_t)yBeg * width);
+        });
+    }
+    pool.wait();
+    for (unsigned band = 0; band < bands; band++) {
+        pool.add([&, band]() {
+            vBlur(radius, width, height, outPtr, inPtr, band * width / bands, (band + 1) * width / bands);
+        });
+    }
+    pool.wait();
+    for (unsigned band = 0; band < bands; band++) {
+        pool.add([&, band]() {
+            toPixel32(inPtr, outPalette, width, (band + 1) * height / bands, outP32, band * height / bands);
+        });
+    }
+    pool.wait();
     
     return true;
 }
@@ -52,9 +52,10 @@ public:
     static
     bool blurI8(const PalMapping& mapping, const FPalette& outPalette, const FImage& inI8, FImage& outP32, ImageCfg& cfg, ImageAux& aux, unsigned radius);
     
-    static void toFloat( const PalMapping& mapping, const FImage& inI8, unsigned width, unsigned height, float* grid);
+    // Optional yBeg / xBeg..xEnd limit work to a row or column band of the full grid.
+    static void toFloat( const PalMapping& mapping, const FImage& inI8, unsigned width, unsigned height, float* grid, unsigned yBeg = 0);
     static void hBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* inGrid, float* outGrid);
-    static void vBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* inGrid, float* outGrid);
-    static void toPixel32(const float* inGrid, const FPalette& inPalette, unsigned width, unsigned height, FImage& outP32);
+    static void vBlur(unsigned radius, unsigned xDim, unsigned yDim, const float* inGrid, float* outGrid, unsigned xBeg = 0, unsigned xEnd = ~0u);
+    static void toPixel32(const float* inGrid, const FPalette& inPalette, unsigned width, unsigned height, FImage& outP32, unsigned yBeg = 0);
 
 };
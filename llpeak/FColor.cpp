@@ -123,25 +123,28 @@ FClr::HSV FColor::toHSV() const {
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// sRGB channel to linear light, table per byte value.
+class LinearTable {
+public:
+    float linear[256];
+    LinearTable() {
+        for (unsigned clr = 0; clr < 256; clr++) {
+            float c = clr / 255.0;
+            if (c > 0.04045)
+                c = powf(( (c + 0.055) / 1.055 ), 2.4);
+            else c /= 12.92;
+            linear[clr] = c * 100;
+        }
+    }
+};
+
 //-------------------------------------------------------------------------------------------------
 FClr::XYZ FColor::toXYZ() const {
-    float r = rgbRed / 255.0;
-    float g = rgbGreen / 255.0;
-    float b = rgbBlue / 255.0;
-    
-    if (r > 0.04045)
-        r = powf(( (r + 0.055) / 1.055 ), 2.4);
-    else r /= 12.92;
-    
-    if (g > 0.04045)
-        g = powf(( (g + 0.055) / 1.055 ), 2.4);
-    else g /= 12.92;
-    
-    if (b > 0.04045)
-        b = powf(( (b + 0.055) / 1.055 ), 2.4);
-    else b /= 12.92;
-    
-    r *= 100; g *= 100; b *= 100;
+    static const LinearTable table;
+    float r = table.linear[rgbRed];
+    float g = table.linear[rgbGreen];
+    float b = table.linear[rgbBlue];
     
     // Calibration for observer @2° with illumination = D65
     float x = r * 0.4124 + g * 0.3576 + b * 0.1805;
@@ -167,16 +170,16 @@ FClr::LAB FClr::XYZ::toLAB() const {
     else xn = (7.787 * xn) + (16.0 / 116.0);
     
     if (yn > 0.008856)
-        yn = powf(y, 1 / 3.0);
+        yn = powf(yn, 1 / 3.0);
     else yn = (7.787 * yn) + (16.0 / 116.0);
     
     if (zn > 0.008856)
-        zn = powf(z, 1 / 3.0);
+        zn = powf(zn, 1 / 3.0);
     else zn = (7.787 * zn) + (16.0 / 116.0);
     
-    l = 116 * y - 16;
-    a = 500 * (x - y);
-    b = 200 * (y - z);
+    l = 116 * yn - 16;
+    a = 500 * (xn - yn);
+    b = 200 * (yn - zn);
     
     return LAB(l, a, b);
 }
@@ -98,6 +98,11 @@ public:
     
     LAB(float _l, float _a, float _b) : l(_l), a(_a), b(_b)
     { }
+    
+    // CIE76 DeltaE squared.
+    float distance2(const LAB& other) const {
+        return (l - other.l) * (l - other.l) + (a - other.a) * (a - other.a) + (b - other.b) * (b - other.b);
+    }
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -105,7 +110,7 @@ public:
 class XYZ {
 public:
     float x, y, z;
-    XYZ(float _x, float _y, float _z) : x(_z), y(_y), z(_z)
+    XYZ(float _x, float _y, float _z) : x(_x), y(_y), z(_z)
     { }
     
     LAB toLAB() const;
@@ -169,6 +174,12 @@ public:
         return *((DWORD*) this) != *((DWORD*) &other);
     }
     
+    // Packed RGBA, used as hash key.
+    inline
+    DWORD rgba() const {
+        return *((DWORD*) this);
+    }
+    
     inline
     RGBQUAD* quad() const {
         return (RGBQUAD*)this;  // Cast away const
@@ -178,6 +189,9 @@ public:
 
     FClr::HSV toHSV() const;
     FClr::XYZ toXYZ() const;
+    FClr::LAB toLAB() const {
+        return toXYZ().toLAB();
+    }
     
     inline
     double luminosity() const {
@@ -320,13 +334,8 @@ public:
     // CIE76 - Delta E
     inline
     float distanceDeltaE(const FColor& other) const {
-        FClr::XYZ xyzC1 = toXYZ(), xyzC2 = other.toXYZ();
-        FClr::LAB labC1 = xyzC1.toLAB(), labC2 = xyzC2.toLAB();
-        float deltaE;
-
         // Euclidian Distance between two points in 3D matrices
-        deltaE = sqrtf( powf(labC1.l - labC2.l, 2) + powf(labC1.a - labC2.a, 2) + powf(labC1.b - labC2.b, 2) );
-        return deltaE;
+        return sqrtf(toLAB().distance2(other.toLAB()));
     }
     
     inline
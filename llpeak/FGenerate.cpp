@@ -0,0 +1,208 @@
+//-------------------------------------------------------------------------------------------------
+// File: FGenerate.cpp
+// Desc: Deterministic synthetic radar sequence (moving, growing storm blobs)
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "FGenerate.hpp"
+#include "ImageUtilF.hpp"
+#include "FileUtil.hpp"
+#include "Progress.hpp"
+#include "TaskPool.hpp"
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+
+static const unsigned LEVELS = 1024;    // Intensity histogram bins for coverage threshold
+
+//-------------------------------------------------------------------------------------------------
+// Uniform float in [lo, hi)
+static float Uniform(unsigned& state, float lo, float hi) {
+    return lo + (hi - lo) * (FGenerate::XorShift(state) >> 8) / (float)(1 << 24);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Blob start state, one per 200x200 pixels (at least 3), sized to the image and coverage.
+std::vector<FGenerate::Blob> FGenerate::MakeBlobs(const Options& options) {
+    unsigned state = options.seed != 0 ? options.seed : 1;
+    unsigned blobCnt = std::max(3u, options.width * options.height / 40000);
+    float dim = (float)std::min(options.width, options.height);
+    float speed = dim / std::max(options.frames, 1u);
+    // Blobs cover about twice the wanted coverage, threshold trims the rest.
+    float area = 2.0f * std::max(options.coverage, 0.01f) * options.width * options.height;
+    float avgRadius = std::min(std::sqrt(area / (3.14159f * blobCnt)), dim / 2);
+    
+    std::vector<Blob> blobs(blobCnt);
+    for (Blob& blob : blobs) {
+        blob.x = Uniform(state, 0, (float)options.width);
+        blob.y = Uniform(state, 0, (float)options.height);
+        blob.dx = Uniform(state, 0.2f, 1.0f) * speed;
+        blob.dy = Uniform(state, -0.5f, 0.5f) * speed;
+        blob.radius = Uniform(state, 0.6f, 1.2f) * avgRadius;
+        blob.growth = Uniform(state, -0.2f, 0.5f) * blob.radius / std::max(options.frames, 1u);
+        blob.peak = Uniform(state, 0.6f, 1.0f);
+    }
+    return blobs;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Intensity 0..1 per pixel, maximum of blob falloff with cell texture. Blobs wrap at edges.
+void FGenerate::Field(const std::vector<Blob>& blobs, const Options& options, unsigned frameIdx, std::vector<float>& field) {
+    unsigned width = options.width;
+    unsigned height = options.height;
+    field.assign((size_t)width * height, 0.0f);
+    
+    for (const Blob& blob : blobs) {
+        float radius = std::max(2.0f, blob.radius + blob.growth * frameIdx);
+        float cx = std::fmod(blob.x + blob.dx * frameIdx, (float)width);
+        float cy = std::fmod(blob.y + blob.dy * frameIdx, (float)height);
+        cx += (cx < 0) ? width : 0;
+        cy += (cy < 0) ? height : 0;
+        
+        int reach = (int)std::ceil(radius);
+        for (int oy = -reach; oy <= reach; oy++) {
+            int y = ((int)cy + oy) % (int)height;
+            y += (y < 0) ? height : 0;
+            float* row = field.data() + (size_t)y * width;
+            for (int ox = -reach; ox <= reach; ox++) {
+                float dist2 = (ox * ox + oy * oy) / (radius * radius);
+                if (dist2 >= 1.0f)
+                    continue;
+                int x = ((int)cx + ox) % (int)width;
+                x += (x < 0) ? width : 0;
+                
+                // Convective cells, stable texture per 4x4 block that drifts with the blob.
+                unsigned cell = (unsigned)((x - (int)(blob.dx * frameIdx)) >> 2) * 73856093u
+                    ^ (unsigned)((y - (int)(blob.dy * frameIdx)) >> 2) * 19349663u ^ options.seed;
+                cell += (cell == 0);
+                XorShift(cell);
+                float texture = 0.85f + 0.15f * (cell & 0xff) / 255.0f;
+                float value = blob.peak * (1.0f - dist2) * texture;
+                row[x] = std::max(row[x], value);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+FImage FGenerate::Frame(const FPalette& palette, const Options& options, unsigned frameIdx) {
+    std::vector<float> field;
+    Field(MakeBlobs(options), options, frameIdx, field);
+    
+    // Opaque colors are intensity levels, first transparent color is background.
+    std::vector<unsigned> levels;
+    unsigned clearIdx = 0;
+    bool haveClear = false;
+    for (unsigned idx = 0; idx < palette.size() && idx < 256; idx++) {
+        if (palette[idx].rgbReserved != 0) {
+            levels.push_back(idx);
+        } else if (!haveClear) {
+            clearIdx = idx;
+            haveClear = true;
+        }
+    }
+    if (levels.empty())
+        levels.push_back(clearIdx);
+    
+    // Threshold so coverage fraction of pixels are above it.
+    std::vector<size_t> histo(LEVELS, 0);
+    for (float value : field)
+        histo[std::min((unsigned)(value * LEVELS), LEVELS - 1)]++;
+    size_t want = (size_t)(options.coverage * field.size());
+    size_t above = 0;
+    unsigned threshold = LEVELS;
+    while (threshold > 1 && above + histo[threshold - 1] <= want) {
+        above += histo[--threshold];
+    }
+    float minValue = threshold / (float)LEVELS;
+    float scale = levels.size() / std::max(1.0f - minValue, 1e-6f);
+    
+    unsigned width = options.width;
+    unsigned height = options.height;
+    FImage img = FImage::Create(width, height, options.bits == 32 ? 32 : 8);
+    if (options.bits != 32) {
+        FPalette outPalette(palette);
+        if (outPalette.size() > 256)
+            outPalette.resize(256);
+        img.setPalette(outPalette);
+    }
+    for (unsigned y = 0; y < height; y++) {
+        const float* row = field.data() + (size_t)(height - 1 - y) * width;  // Scanline 0 is bottom
+        BYTE* outI8 = img.ScanLine(y);
+        FColor* outP32 = (FColor*)outI8;
+        for (unsigned x = 0; x < width; x++) {
+            unsigned clrIdx = clearIdx;
+            if (row[x] >= minValue && row[x] > 0) {
+                unsigned level = std::min((unsigned)((row[x] - minValue) * scale), (unsigned)levels.size() - 1);
+                clrIdx = levels[level];
+            }
+            if (options.bits == 32)
+                outP32[x] = palette[clrIdx];
+            else
+                outI8[x] = (BYTE)clrIdx;
+        }
+    }
+    return img;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Save frames as <outDir>frame-0000.png ... generated in parallel.
+bool FGenerate::Save(const FPalette& palette, const Options& options, const lstring& outDir, unsigned threads) {
+    if (palette.empty()) {
+        std::cerr << "Generate needs a palette, use -config <cfg.json>\n";
+        return false;
+    }
+    if (!outDir.empty() && !FileUtil::makeDirs(outDir))
+        return false;
+    
+    std::atomic<unsigned> failed(0);
+    TaskPool pool(threads);
+    for (unsigned frameIdx = 0; frameIdx < options.frames; frameIdx++) {
+        pool.add([&palette, &options, &outDir, &failed, frameIdx]() {
+            char name[40];
+            snprintf(name, sizeof(name), "frame-%04u.png", frameIdx);
+            FImage img = Frame(palette, options, frameIdx);
+            if (!ImageUtilF::saveTo(img, outDir + name, false)) {
+                std::cerr << "Failed to save " << outDir + name << std::endl;
+                failed++;
+            }
+            img.Close();
+            Progress::frameDone();
+        });
+    }
+    pool.wait();
+    
+    std::cout << "Generated " << options.frames << " frames " << options.width << "x" << options.height
+        << " " << options.bits << "bit coverage " << options.coverage << " in " << outDir << std::endl;
+    return failed == 0;
+}
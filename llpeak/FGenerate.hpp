@@ -0,0 +1,80 @@
+//-------------------------------------------------------------------------------------------------
+// File: FGenerate.hpp
+// Desc: Deterministic synthetic radar sequence (moving, growing storm blobs)
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+// Project files
+#include "FImage.hpp"
+#include "FPalette.hpp"
+#include "ll_stdhdr.hpp"
+
+// C++
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// Synthetic radar frames for reproducible benchmarks, same options always give same pixels.
+// Storm blobs move and grow over the sequence, intensity is quantized to the palette's
+// opaque colors (in order, weakest first). Threshold per frame keeps the coverage fraction.
+class FGenerate {
+public:
+    struct Options {
+        unsigned width = 640;
+        unsigned height = 480;
+        unsigned frames = 100;
+        float    coverage = 0.25f;  // Fraction of non-transparent pixels
+        unsigned bits = 8;          // 8 = palette image, 32 = RGBA image
+        unsigned seed = 1;
+    };
+    
+    static bool Save(const FPalette& palette, const Options& options, const lstring& outDir, unsigned threads = 0);
+    static FImage Frame(const FPalette& palette, const Options& options, unsigned frameIdx);
+    
+    // xorshift32 pseudo random, never returns 0 for non-zero state.
+    static unsigned XorShift(unsigned& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    
+private:
+    struct Blob {
+        float x, y;         // Start center
+        float dx, dy;       // Motion per frame
+        float radius;       // Start radius
+        float growth;       // Radius change per frame
+        float peak;         // Maximum intensity 0..1
+    };
+    static std::vector<Blob> MakeBlobs(const Options& options);
+    static void Field(const std::vector<Blob>& blobs, const Options& options, unsigned frameIdx, std::vector<float>& field);
+};
@@ -37,21 +37,35 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "FImage.hpp"
+#include <atomic>
 #include <iostream>
 #include <math.h>
 
-unsigned FImage::DBG_CNT = 0;
-
-void FIMAGE_DELETER(FIBITMAP* imgPtr) {
-    FreeImage_Unload(imgPtr);
-}
-FBitmapRef::FBitmapRef(FIBITMAP* imgPtr) : shared_ptr(imgPtr, FIMAGE_DELETER) {
+//-------------------------------------------------------------------------------------------------
+// Unload bitmap and release its memory accounting.
+// Category is atomic, images sharing the bitmap may change it from other threads.
+struct FBitmapDeleter {
+    size_t bytes;
+    std::atomic<FMemory::Category> category;
+    
+    FBitmapDeleter(size_t _bytes, FMemory::Category _category) : bytes(_bytes), category(_category) {
+    }
+    FBitmapDeleter(const FBitmapDeleter& other) : bytes(other.bytes), category(other.category.load()) {
+    }
     
+    void operator()(FIBITMAP* imgPtr) const {
+        if (imgPtr != nullptr)
+            FMemory::release(category, bytes);
+        FreeImage_Unload(imgPtr);
+    }
+};
+
+FBitmapRef::FBitmapRef(FIBITMAP* imgPtr) :
+        shared_ptr(imgPtr, FBitmapDeleter(FMemory::acquire(imgPtr), FMemory::FRAME)) {
 }
 
 //-------------------------------------------------------------------------------------------------
 FImage::FImage(FIBITMAP* _imgPtr) : imgPtr(_imgPtr) { 
-    DBG_CNT++; 
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -59,14 +73,20 @@ void FImage::Close() {
     if (Valid()) {
         // FreeImage_Unload(imgPtr);
         imgPtr = nullptr;
-        // std::cout << "close cnt=" << --DBG_CNT << std::endl;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void FImage::setCategory(FMemory::Category category) {
+    FBitmapDeleter* deleter = std::get_deleter<FBitmapDeleter>(imgPtr);
+    if (deleter != nullptr && Valid()) {
+        FMemory::move(deleter->category.exchange(category), category, deleter->bytes);
     }
 }
 
 //-------------------------------------------------------------------------------------------------
 bool FImage::LoadFromHandle(FREE_IMAGE_FORMAT fif, FreeImageIO *io, fi_handle handle, int flags) {
     Close();
-    DBG_CNT++;
     imgPtr = FreeImage_LoadFromHandle(fif, io, handle, flags);
     return Valid();
 }
@@ -42,6 +42,7 @@
 #include "FPalette.hpp"
 #include "FColor.hpp"
 #include "FBrush.hpp"
+#include "FMemory.hpp"
 
 #include "FreeImage.h"
 #include <iostream>
@@ -70,7 +71,7 @@ public:
     // FImageRef& operator=(const FImageRef&) = default;   // default copy semantics
     // FImageRef(const FImageRef&) = default;
 
-    FBitmapRef(FIBITMAP* imgPtr); //  : shared_ptr(imgPtr, FIMAGE_DELETER) { }
+    FBitmapRef(FIBITMAP* imgPtr); //  : shared_ptr(imgPtr, FBitmapDeleter) { }
     FIBITMAP* ref() { return get(); }
     const FIBITMAP* cref() const { return get(); }
     // operator FIBITMAP*() { return get(); }
@@ -81,7 +82,6 @@ public:
 class FImage {
 public:
 
-    static unsigned DBG_CNT;
     // FIBITMAP* imgPtr;
     FBitmapRef imgPtr;
 
@@ -90,6 +90,10 @@ public:
     FImage(FIBITMAP* _imgPtr);
     FImage(const FImage& other) : imgPtr(other.imgPtr)
     { }
+    FImage& operator=(const FImage& other) {
+        imgPtr = other.imgPtr;
+        return *this;
+    }
     ~FImage() {
         if (imgPtr.use_count() == 0) {
             Close();
@@ -97,6 +101,8 @@ public:
     }
 
     void Close();
+    // Move bitmap to another memory accounting category (see FMemory).
+    void setCategory(FMemory::Category category);
 
     bool Valid() const 
     { return (imgPtr != nullptr); }
@@ -157,6 +163,8 @@ public:
     { FreeImage_SetTransparencyTable(imgPtr, (BYTE*)transArray, arrayLen); }
     const BYTE* GetTransparencyTable() const 
     { return FreeImage_GetTransparencyTable(imgPtr); }
+    unsigned GetTransparencyCount() const 
+    { return FreeImage_GetTransparencyCount(imgPtr); }
     BYTE* TransparencyTable()  
     { return FreeImage_GetTransparencyTable(imgPtr); }
     unsigned ApplyPaletteIndexMapping(const BYTE *srcindices, const BYTE *dstindices, unsigned count, bool swap = false) 
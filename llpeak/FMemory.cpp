@@ -0,0 +1,158 @@
+//-------------------------------------------------------------------------------------------------
+// File: FMemory.cpp
+// Desc: Live image memory accounting, high-water report and -max-memory budget
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "FMemory.hpp"
+#include "RunStats.hpp"
+
+// C++
+#include <chrono>
+#include <iomanip>
+
+
+size_t FMemory::maxBytes = 0;
+std::atomic<size_t> FMemory::liveCnt[FMemory::CATEGORY_CNT];
+std::atomic<size_t> FMemory::liveSize[FMemory::CATEGORY_CNT];
+std::atomic<size_t> FMemory::peakSize[FMemory::CATEGORY_CNT];
+std::atomic<size_t> FMemory::totalCnt(0);
+std::atomic<size_t> FMemory::totalBytes(0);
+std::atomic<size_t> FMemory::peakCnt(0);
+std::atomic<size_t> FMemory::peakBytes(0);
+std::atomic<size_t> FMemory::stuckBytes(0);
+std::mutex FMemory::mutex;
+std::condition_variable FMemory::released;
+
+//-------------------------------------------------------------------------------------------------
+void FMemory::raise(std::atomic<size_t>& peak, size_t value) {
+    size_t prev = peak;
+    while (value > prev && !peak.compare_exchange_weak(prev, value))
+        ;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Count new bitmap, return its size in bytes (pixels plus palette, header-only has no pixels).
+size_t FMemory::acquire(const FIBITMAP* imgPtr, Category category) {
+    if (imgPtr == nullptr)
+        return 0;
+    FIBITMAP* dib = (FIBITMAP*)imgPtr;
+    size_t bytes = FreeImage_GetColorsUsed(dib) * sizeof(RGBQUAD);
+    if (FreeImage_HasPixels(dib)) {
+        bytes += (size_t)FreeImage_GetLine(dib) * FreeImage_GetHeight(dib);
+    }
+    
+    liveCnt[category]++;
+    raise(peakSize[category], liveSize[category] += bytes);
+    raise(peakCnt, ++totalCnt);
+    raise(peakBytes, totalBytes += bytes);
+    return bytes;
+}
+
+//-------------------------------------------------------------------------------------------------
+void FMemory::release(Category category, size_t bytes) {
+    liveCnt[category]--;
+    liveSize[category] -= bytes;
+    totalCnt--;
+    totalBytes -= bytes;
+    if (maxBytes != 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.notify_all();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void FMemory::move(Category from, Category to, size_t bytes) {
+    if (from != to) {
+        liveCnt[from]--;
+        liveSize[from] -= bytes;
+        liveCnt[to]++;
+        raise(peakSize[to], liveSize[to] += bytes);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Over budget, wait for other threads (savers, pipeline stages) to release bitmaps.
+// Give up after a second without any release, the working set alone exceeds the budget.
+// Later calls do not wait again until releases bring the total below that level.
+bool FMemory::waitBudget() {
+    if (!overBudget())
+        return true;
+    if (stuckBytes != 0 && totalBytes >= stuckBytes)
+        return false;
+    
+    StageTimer timer(RunStats::MEM_WAIT);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (overBudget()) {
+        if (released.wait_for(lock, std::chrono::seconds(1)) == std::cv_status::timeout) {
+            stuckBytes = totalBytes.load();
+            static std::once_flag warned;
+            std::call_once(warned, []() {
+                std::cerr << "Image memory " << (totalBytes >> 20) << " MB exceeds -max-memory "
+                    << (maxBytes >> 20) << " MB, continuing\n";
+            });
+            return false;
+        }
+    }
+    stuckBytes = 0;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+const char* FMemory::name(Category category) {
+    static const char* names[] = { "frame", "overlay", "save-queue", "montage" };
+    return (category < CATEGORY_CNT) ? names[category] : "?";
+}
+
+//-------------------------------------------------------------------------------------------------
+void FMemory::print(std::ostream& out) {
+    const double MB = 1024.0 * 1024.0;
+    out << "\nMemory       Live    Live(MB)    Peak(MB)\n" << std::fixed << std::setprecision(1);
+    for (unsigned idx = 0; idx < CATEGORY_CNT; idx++) {
+        out << std::left << std::setw(10) << name((Category)idx) << std::right
+            << std::setw(7) << liveCnt[idx]
+            << std::setw(12) << liveSize[idx] / MB
+            << std::setw(12) << peakSize[idx] / MB << std::endl;
+    }
+    out.unsetf(std::ios::floatfield);
+    printPeak(out);
+}
+
+//-------------------------------------------------------------------------------------------------
+void FMemory::printPeak(std::ostream& out) {
+    const double MB = 1024.0 * 1024.0;
+    out << "Image memory peak " << std::fixed << std::setprecision(1) << peakBytes / MB
+        << " MB, " << peakCnt << " bitmaps";
+    if (maxBytes != 0)
+        out << ", budget " << maxBytes / MB << " MB";
+    out << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
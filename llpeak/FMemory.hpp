@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------------------------------------
+// File: FMemory.hpp
+// Desc: Live image memory accounting, high-water report and -max-memory budget
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "ll_stdhdr.hpp"
+#include "FreeImage.h"
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+
+//-------------------------------------------------------------------------------------------------
+// Live bitmap count and bytes per category, with peaks.
+// Bitmaps are counted when wrapped by FBitmapRef and released by its deleter.
+class FMemory {
+public:
+    enum Category { FRAME, OVERLAY, SAVE_QUEUE, MONTAGE, CATEGORY_CNT };
+    
+    static size_t maxBytes;     // -max-memory budget, 0 = unlimited
+    
+    static size_t acquire(const FIBITMAP* imgPtr, Category category = FRAME);
+    static void release(Category category, size_t bytes);
+    static void move(Category from, Category to, size_t bytes);
+    
+    static size_t liveBytes() {
+        return totalBytes;
+    }
+    static bool overBudget() {
+        return maxBytes != 0 && totalBytes > maxBytes;
+    }
+    // Stall while over budget, false if nothing was released for a while.
+    static bool waitBudget();
+    
+    static const char* name(Category category);
+    static void print(std::ostream& out);
+    static void printPeak(std::ostream& out);
+    
+private:
+    static std::atomic<size_t> liveCnt[CATEGORY_CNT];
+    static std::atomic<size_t> liveSize[CATEGORY_CNT];
+    static std::atomic<size_t> peakSize[CATEGORY_CNT];
+    static std::atomic<size_t> totalCnt;
+    static std::atomic<size_t> totalBytes;
+    static std::atomic<size_t> peakCnt;
+    static std::atomic<size_t> peakBytes;
+    static std::atomic<size_t> stuckBytes;     // Total when a wait gave up, 0 = none
+    static std::mutex mutex;
+    static std::condition_variable released;
+    
+    static void raise(std::atomic<size_t>& peak, size_t value);
+};
@@ -41,12 +41,139 @@
 #include "FPalette.hpp"
 #include "FPrint.hpp"
 #include "MapVector.hpp"
+#include "LruCache.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <vector>
 
+//-------------------------------------------------------------------------------------------------
+FPalette::ColorIndex::ColorIndex(const FPalette& palette) {
+    unsigned tableSize = 16;
+    while (tableSize < palette.size() * 2) {
+        tableSize *= 2;
+    }
+    mask = tableSize - 1;
+    keys.resize(tableSize);
+    slots.resize(tableSize, (unsigned)NO_MATCH);
+    std::fill(alphaSlot, alphaSlot + 256, (unsigned)NO_MATCH);
+    
+    for (unsigned idx = 0; idx < palette.size(); idx++) {
+        const FColor& color = palette[idx];
+        DWORD key = color.rgba();
+        unsigned pos = hashPos(key);
+        while (slots[pos] != NO_MATCH && keys[pos] != key) {
+            pos = (pos + 1) & mask;
+        }
+        if (slots[pos] == NO_MATCH) {   // Keep first slot of duplicate colors
+            keys[pos] = key;
+            slots[pos] = idx;
+        }
+        if (alphaSlot[color.rgbReserved] == NO_MATCH) {
+            alphaSlot[color.rgbReserved] = idx;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Alpha scaled to about the LAB lightness range.
+void FPalette::LabTree::toPoint(const FColor& color, float v[4]) {
+    FClr::LAB lab = color.toLAB();
+    v[0] = lab.l;
+    v[1] = lab.a;
+    v[2] = lab.b;
+    v[3] = color.rgbReserved * (100.0f / 255.0f);
+}
+
+//-------------------------------------------------------------------------------------------------
+FPalette::LabTree::LabTree(const FPalette& palette) {
+    nodes.resize(palette.size());
+    for (unsigned idx = 0; idx < palette.size(); idx++) {
+        toPoint(palette[idx], nodes[idx].v);
+        nodes[idx].idx = idx;
+    }
+    build(0, (unsigned)nodes.size());
+}
+
+//-------------------------------------------------------------------------------------------------
+// Split range on axis of largest spread at the median.
+void FPalette::LabTree::build(unsigned lo, unsigned hi) {
+    if (hi - lo < 2) {
+        if (hi > lo)
+            nodes[lo].axis = 0;
+        return;
+    }
+    float minV[4], maxV[4];
+    for (unsigned axis = 0; axis < 4; axis++) {
+        minV[axis] = maxV[axis] = nodes[lo].v[axis];
+    }
+    for (unsigned pos = lo + 1; pos < hi; pos++) {
+        for (unsigned axis = 0; axis < 4; axis++) {
+            minV[axis] = std::min(minV[axis], nodes[pos].v[axis]);
+            maxV[axis] = std::max(maxV[axis], nodes[pos].v[axis]);
+        }
+    }
+    unsigned splitAxis = 0;
+    for (unsigned axis = 1; axis < 4; axis++) {
+        if (maxV[axis] - minV[axis] > maxV[splitAxis] - minV[splitAxis])
+            splitAxis = axis;
+    }
+    
+    unsigned mid = lo + (hi - lo) / 2;
+    std::nth_element(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi,
+        [splitAxis](const Node& n1, const Node& n2) { return n1.v[splitAxis] < n2.v[splitAxis]; });
+    nodes[mid].axis = splitAxis;
+    build(lo, mid);
+    build(mid + 1, hi);
+}
+
+//-------------------------------------------------------------------------------------------------
+void FPalette::LabTree::search(unsigned lo, unsigned hi, const float q[4], float& bestDist, unsigned& bestIdx) const {
+    if (lo >= hi)
+        return;
+    unsigned mid = lo + (hi - lo) / 2;
+    const Node& node = nodes[mid];
+    
+    float dist = 0;
+    for (unsigned axis = 0; axis < 4; axis++) {
+        dist += (q[axis] - node.v[axis]) * (q[axis] - node.v[axis]);
+    }
+    if (dist < bestDist || (dist == bestDist && node.idx < bestIdx)) {
+        bestDist = dist;
+        bestIdx = node.idx;
+    }
+    
+    float delta = q[node.axis] - node.v[node.axis];
+    if (delta < 0) {
+        search(lo, mid, q, bestDist, bestIdx);
+        if (delta * delta <= bestDist)
+            search(mid + 1, hi, q, bestDist, bestIdx);
+    } else {
+        search(mid + 1, hi, q, bestDist, bestIdx);
+        if (delta * delta <= bestDist)
+            search(lo, mid, q, bestDist, bestIdx);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned FPalette::findClosestLAB(const FColor& color4, float* distPtr) const {
+    float bestDist = std::numeric_limits<float>::max();
+    unsigned bestIdx = NO_CLOSEST;
+    if (!empty()) {
+        float q[4];
+        LabTree::toPoint(color4, q);
+        const LabTree& tree = getShared(labTree);
+        tree.search(0, (unsigned)tree.nodes.size(), q, bestDist, bestIdx);
+    }
+    if (distPtr != nullptr) {
+        *distPtr = sqrtf(bestDist);
+    }
+    return bestIdx;
+}
+
 //-------------------------------------------------------------------------------------------------
 unsigned FPalette::findClosest(const FColor& color4, float* distPtr, float maxDst,  unsigned failIdx) const {
     const FClr::HSV hsv = color4.toHSV();
@@ -77,6 +204,10 @@ unsigned FPalette::findClosest(const FColor& color4, float* distPtr, float maxDs
 
 //-------------------------------------------------------------------------------------------------
 unsigned FPalette::findAlpha(const FColor& color4, unsigned failIdx) const {
+    if (color4.rgbReserved != 0xff && hasTransparency && size() >= INDEX_MIN) {
+        unsigned idx = getIndex().alphaSlot[color4.rgbReserved];
+        return (idx != NO_MATCH) ? idx : failIdx;
+    }
     if (color4.rgbReserved != 0xff && hasTransparency) {
         for (unsigned idx = 0; idx < size(); idx++) {
             const FColor& color = at(idx);
@@ -89,7 +220,33 @@ unsigned FPalette::findAlpha(const FColor& color4, unsigned failIdx) const {
 }
 
 //-------------------------------------------------------------------------------------------------
+// Cached mapping, palettes kept to reject hash collisions.
+class MappingEntry {
+public:
+    FPalette srcPalette;
+    FPalette dstPalette;
+    PalMapping mapping;
+};
+static LruCache<size_t, MappingEntry> mappingCache(32);
+
+//-------------------------------------------------------------------------------------------------
+// Source palettes rarely change between frames, reuse mapping when both palettes match.
 PalMapping  FPalette::getMapping(const FPalette& srcPalette, const FPalette& dstPalette)  {
+    size_t key = srcPalette.hash() * 31 + dstPalette.hash();
+    MappingEntry entry;
+    if (mappingCache.Get(key, entry) && entry.srcPalette.same(srcPalette) && entry.dstPalette.same(dstPalette)) {
+        return entry.mapping;
+    }
+    
+    entry.srcPalette = srcPalette;
+    entry.dstPalette = dstPalette;
+    entry.mapping = makeMapping(srcPalette, dstPalette);
+    mappingCache.Put(key, entry);
+    return entry.mapping;
+}
+
+//-------------------------------------------------------------------------------------------------
+PalMapping  FPalette::makeMapping(const FPalette& srcPalette, const FPalette& dstPalette)  {
     PalMapping mapping;
     // const FPalette& dstPalette = getOutPalette();
     for (unsigned srcIdx = 0; srcIdx < srcPalette.size(); srcIdx++) {
@@ -43,12 +43,16 @@
 #include "FColor.hpp"
 #include "PalMapping.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <string>
 
 
 
 //-------------------------------------------------------------------------------------------------
+// Palette colors with optional exact color index (built on first lookup, dropped by mutating calls).
 class FPalette : public std::vector<FColor> {
     
 public:
@@ -69,12 +73,121 @@ public:
         }
     }
     
+    // Index is not copied, copy builds its own on first lookup.
+    FPalette(const FPalette& other)
+        : Vec(other), hasTransparency(other.hasTransparency), names(other.names) {
+    }
+    FPalette& operator=(const FPalette& other) {
+        if (this != &other) {
+            Vec::operator=(other);
+            hasTransparency = other.hasTransparency;
+            names = other.names;
+            invalidate();
+        }
+        return *this;
+    }
+    
     typedef std::vector<FColor> Vec;
-    using Vec::push_back;
+    
+    // Vector calls which can change colors drop the color index.
+    void push_back(const FColor& color) {
+        invalidate();
+        Vec::push_back(color);
+    }
     void push_back(const FColor& color, const std::string& name) {
         push_back(color);
         names.push_back(name);
     }
+    template <class... Args> void emplace_back(Args&&... args) {
+        invalidate();
+        Vec::emplace_back(std::forward<Args>(args)...);
+    }
+    template <class... Args> iterator emplace(Args&&... args) {
+        invalidate();
+        return Vec::emplace(std::forward<Args>(args)...);
+    }
+    void pop_back() {
+        invalidate();
+        Vec::pop_back();
+    }
+    void clear() {
+        invalidate();
+        Vec::clear();
+    }
+    template <class... Args> iterator erase(Args&&... args) {
+        invalidate();
+        return Vec::erase(std::forward<Args>(args)...);
+    }
+    template <class... Args> iterator insert(Args&&... args) {
+        invalidate();
+        return Vec::insert(std::forward<Args>(args)...);
+    }
+    template <class... Args> void resize(Args&&... args) {
+        invalidate();
+        Vec::resize(std::forward<Args>(args)...);
+    }
+    template <class... Args> void assign(Args&&... args) {
+        invalidate();
+        Vec::assign(std::forward<Args>(args)...);
+    }
+    void swap(FPalette& other) {
+        invalidate();
+        other.invalidate();
+        Vec::swap(other);
+        std::swap(hasTransparency, other.hasTransparency);
+        names.swap(other.names);
+    }
+    
+    // Non-const element access may write a color.
+    FColor& operator[](size_t idx) {
+        invalidate();
+        return Vec::operator[](idx);
+    }
+    const FColor& operator[](size_t idx) const {
+        return Vec::operator[](idx);
+    }
+    FColor& at(size_t idx) {
+        invalidate();
+        return Vec::at(idx);
+    }
+    const FColor& at(size_t idx) const {
+        return Vec::at(idx);
+    }
+    FColor& front() {
+        invalidate();
+        return Vec::front();
+    }
+    const FColor& front() const {
+        return Vec::front();
+    }
+    FColor& back() {
+        invalidate();
+        return Vec::back();
+    }
+    const FColor& back() const {
+        return Vec::back();
+    }
+    iterator begin() {
+        invalidate();
+        return Vec::begin();
+    }
+    const_iterator begin() const {
+        return Vec::begin();
+    }
+    iterator end() {
+        invalidate();
+        return Vec::end();
+    }
+    const_iterator end() const {
+        return Vec::end();
+    }
+    FColor* data() {
+        invalidate();
+        return Vec::data();
+    }
+    const FColor* data() const {
+        return Vec::data();
+    }
     
     FPalette& spread(FPalette& outPalette, unsigned inSize=0, unsigned outSize=256) const;
     
@@ -84,8 +197,15 @@ public:
   
     unsigned findClosest(const FColor& color4, float* distPtr=nullptr, float maxDst=256*256, unsigned failIdx=NO_CLOSEST) const;
     unsigned findAlpha(const FColor& color4, unsigned failIdx=256) const;
+    // Nearest by CIE76 DeltaE plus alpha difference, k-d tree searched, first slot wins ties.
+    // Used by ToIndexed, which quantizes 32bit BlendP32/Colorlapse output when -indexed.
+    unsigned findClosestLAB(const FColor& color4, float* distPtr=nullptr) const;
 
+    // First slot with exact color, hash indexed when palette has INDEX_MIN or more colors.
     unsigned findColor(FColor color4, unsigned defIdx=NO_MATCH) const {
+        if (size() >= INDEX_MIN) {
+            return getIndex().find(color4.rgba(), defIdx);
+        }
         for (unsigned idx = 0; idx < size(); idx++) {
             const FColor& ours = at(idx);
             if (color4 == ours)
@@ -103,9 +223,96 @@ public:
         return *this;
     }
     
+    // Nearest color mapping, cached by palette hash (see LruCache).
     static PalMapping getMapping(const FPalette& srcPalette, const FPalette& dstPalette);
+    
+    // FNV-1a hash of colors and transparency flag.
+    size_t hash() const {
+        size_t value = (size_t)14695981039346656037ULL;
+        for (const FColor& color : *this) {
+            value = (value ^ color.rgba()) * (size_t)1099511628211ULL;
+        }
+        return (value ^ (hasTransparency ? 1 : 0)) * (size_t)1099511628211ULL;
+    }
+    // Same colors and transparency flag.
+    bool same(const FPalette& other) const {
+        return hasTransparency == other.hasTransparency
+            && size() == other.size() && std::equal(begin(), end(), other.begin());
+    }
     unsigned merge(const FPalette& inPal, unsigned maxDst=256, unsigned maxColors=256);
     
+private:
+    static PalMapping makeMapping(const FPalette& srcPalette, const FPalette& dstPalette);
+    
+    static const unsigned INDEX_MIN = 16;
+    
+    // Open addressing table, packed RGBA to first slot, plus first slot per alpha.
+    class ColorIndex {
+    public:
+        std::vector<DWORD> keys;
+        std::vector<unsigned> slots;    // NO_MATCH = empty
+        unsigned mask = 0;
+        unsigned alphaSlot[256];
+        
+        ColorIndex(const FPalette& palette);
+        unsigned find(DWORD key, unsigned defIdx) const {
+            for (unsigned pos = hashPos(key); ; pos = (pos + 1) & mask) {
+                if (slots[pos] == NO_MATCH)
+                    return defIdx;
+                if (keys[pos] == key)
+                    return slots[pos];
+            }
+        }
+        unsigned hashPos(DWORD key) const {
+            return (unsigned)((key * 2654435761u) >> 7) & mask;
+        }
+    };
+    
+    // Static k-d tree over (L, a, b, alpha) of palette colors.
+    class LabTree {
+    public:
+        class Node {
+        public:
+            float v[4];
+            unsigned idx;
+            unsigned axis;
+        };
+        std::vector<Node> nodes;    // Median of each range is its node
+        
+        LabTree(const FPalette& palette);
+        static void toPoint(const FColor& color, float v[4]);
+        void search(unsigned lo, unsigned hi, const float q[4], float& bestDist, unsigned& bestIdx) const;
+    private:
+        void build(unsigned lo, unsigned hi);
+    };
+    
+    // Shared so concurrent readers can publish a lazily built index without a lock.
+    mutable std::shared_ptr<const ColorIndex> colorIndex;
+    mutable std::shared_ptr<const LabTree> labTree;
+    
+    // Build once, first published wins and stays until a mutation.
+    template <class T>
+    const T& getShared(std::shared_ptr<const T>& slot) const {
+        std::shared_ptr<const T> found = std::atomic_load(&slot);
+        if (!found) {
+            std::shared_ptr<const T> built = std::make_shared<T>(*this);
+            if (std::atomic_compare_exchange_strong(&slot, &found, built)) {
+                found = built;
+            }
+        }
+        return *found;
+    }
+    const ColorIndex& getIndex() const {
+        return getShared(colorIndex);
+    }
+    void invalidate() {
+        if (std::atomic_load(&colorIndex))
+            std::atomic_store(&colorIndex, std::shared_ptr<const ColorIndex>());
+        if (std::atomic_load(&labTree))
+            std::atomic_store(&labTree, std::shared_ptr<const LabTree>());
+    }
+public:
+    
     
     // See "The incredibly challenging task of sorting colours"
     // https://www.alanzucconi.com/2015/09/30/colour-sorting/
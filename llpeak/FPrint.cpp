@@ -40,17 +40,27 @@
 #include "FPrint.hpp"
 
 #include <iostream>
+#include <string>
+
+//-------------------------------------------------------------------------------------------------
+// Count with thousands separators, ex: 1,234,567
+static std::string grouped(size_t value) {
+    std::string str = std::to_string(value);
+    for (int pos = (int)str.length() - 3; pos > 0; pos -= 3)
+        str.insert((size_t)pos, 1, ',');
+    return str;
+}
 
 //-------------------------------------------------------------------------------------------------
 const char* FPrint::toString(const RGBQUAD& color, const char* fmt) {
-    static char str[40];
+    thread_local char str[40];
     snprintf(str, sizeof(str), fmt, color.rgbRed, color.rgbGreen, color.rgbBlue, color.rgbReserved);
     return str;
 }
 
 //-------------------------------------------------------------------------------------------------
 const char* FPrint::toString(const FClr::HSV& hsv, const char* fmt) {
-    static char str[40];
+    thread_local char str[40];
     snprintf(str, sizeof(str), fmt, hsv.hue, hsv.sat, hsv.value );
     return str;
 }
@@ -121,7 +131,7 @@ unsigned FPrint::printHisto(DWORD* histo, unsigned length, const RGBQUAD* palett
     size_t totalCnt = 0;
     if (histo != NULL) {
         std::cout << "Histogram (" << length << ")\n";
-        setlocale(LC_NUMERIC, "");
+        char line[80];
 
         for (unsigned i = 0; i < length; i++)
             totalCnt += histo[i];
@@ -130,16 +140,19 @@ unsigned FPrint::printHisto(DWORD* histo, unsigned length, const RGBQUAD* palett
             DWORD cnt = histo[i];
             if (cnt != 0) {
                 activeColors++;
-                printf("  %3u: ", i);
+                snprintf(line, sizeof(line), "  %3u: ", i);
+                std::cout << line;
                 if (palettePtr != NULL)
-                    printf("%s", toString(palettePtr[i]));
+                    std::cout << toString(palettePtr[i]);
                 // printf(" RGB(%3d, %3d, %3d)",  palettePtr[i].rgbRed, palettePtr[i].rgbGreen, palettePtr[i].rgbBlue);
 
-                printf(" %'7u #  %3.1f %%\n", cnt, cnt * 100.0f / totalCnt);
+                snprintf(line, sizeof(line), " %7s #  %3.1f %%\n", grouped(cnt).c_str(), cnt * 100.0f / totalCnt);
+                std::cout << line;
                 // totalCnt += cnt;
             }
         }
-        printf(" Total  RGB(red, grn, blu) %'7lu #\n", totalCnt);
+        snprintf(line, sizeof(line), " Total  RGB(red, grn, blu) %7s #\n", grouped(totalCnt).c_str());
+        std::cout << line;
     }
     return activeColors;
 }
@@ -200,8 +213,10 @@ void FPrint::printInfo(const FImage& img, const char* name) {
 void FPrint::printPalette(const RGBQUAD* palettePtr, unsigned colors) {
     if (palettePtr != NULL) {
         std::cout << "Colors (" << colors << ")\n";
+        char line[80];
         for (int i = 0; i < colors; i++) {
-            printf("  [%3d] %s\n", i, toString(palettePtr[i]));
+            snprintf(line, sizeof(line), "  [%3d] %s\n", i, toString(palettePtr[i]));
+            std::cout << line;
         }
     }
 }
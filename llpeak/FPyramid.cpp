@@ -0,0 +1,258 @@
+//-------------------------------------------------------------------------------------------------
+// File: FPyramid.cpp
+// Desc: Write z/x/y (XYZ web map) tile pyramid of an image.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Project files
+#include "FPyramid.hpp"
+#include "FileUtil.hpp"
+#include "ImageUtilF.hpp"
+
+// C++
+#include <atomic>
+#include <iostream>
+
+
+//-------------------------------------------------------------------------------------------------
+lstring FPyramid::DirName(const lstring& imagePath) {
+    size_t slashPos = imagePath.find_last_of("/\\");
+    size_t dotPos = imagePath.find_last_of('.');
+    if (dotPos != std::string::npos && (slashPos == std::string::npos || dotPos > slashPos)) {
+        return imagePath.substr(0, dotPos);
+    }
+    return imagePath + "_tiles";
+}
+
+//-------------------------------------------------------------------------------------------------
+// Smallest zoom where tileSize << zoom covers the image.
+unsigned FPyramid::MaxZoom(unsigned width, unsigned height, unsigned tileSize) {
+    unsigned maxDim = std::max(width, height);
+    unsigned zoom = 0;
+    while (((size_t)tileSize << zoom) < maxDim) {
+        zoom++;
+    }
+    return zoom;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool FPyramid::Save(const FImage& img, const lstring& outDir, unsigned tileSize, unsigned threads, bool verbose) {
+    unsigned bitsPerPixel = img.GetBitsPerPixel();
+    if (bitsPerPixel != 8 && bitsPerPixel != 32) {
+        std::cerr << "Pyramid ignored, unsupported pixel size " << bitsPerPixel << std::endl;
+        return false;
+    }
+    if (tileSize == 0) {
+        return false;
+    }
+    
+    TaskPool pool(threads);
+    unsigned maxZoom = MaxZoom(img.GetWidth(), img.GetHeight(), tileSize);
+    
+    FImage level = img;
+    bool okay = true;
+    for (int zoom = maxZoom; zoom >= 0 && okay; zoom--) {
+        okay = SaveLevel(level, outDir, zoom, tileSize, pool);
+        if (zoom > 0) {
+            level = (bitsPerPixel == 8) ? HalfI8(level, pool) : HalfP32(level, pool);
+        }
+    }
+    
+    if (verbose) {
+        std::cout << "Pyramid " << outDir << " zoom 0.." << maxZoom << std::endl;
+    }
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Split level into tiles, each tile copied and encoded on the pool.
+bool FPyramid::SaveLevel(const FImage& img, const lstring& outDir, unsigned zoom, unsigned tileSize, TaskPool& pool) {
+    unsigned width = img.GetWidth();
+    unsigned height = img.GetHeight();
+    unsigned bitsPerPixel = img.GetBitsPerPixel();
+    unsigned bytesPerPixel = bitsPerPixel / 8;
+    unsigned xTiles = (width + tileSize - 1) / tileSize;
+    unsigned yTiles = (height + tileSize - 1) / tileSize;
+    
+    FPalette palette;
+    BYTE clearIdx = 0;      // Edge tile padding, first transparent palette index
+    if (bitsPerPixel == 8) {
+        img.getPalette(palette);
+        clearIdx = (BYTE)palette.findAlpha(FColor::TRANSPARENT, 0);
+    }
+    
+    lstring zoomDir(outDir);
+    zoomDir += Directory_files::SLASH;
+    zoomDir += std::to_string(zoom);
+    for (unsigned x = 0; x < xTiles; x++) {
+        lstring xDir(zoomDir);
+        xDir += Directory_files::SLASH;
+        xDir += std::to_string(x);
+        if (!FileUtil::makeDirs(xDir)) {
+            std::cerr << "Pyramid failed to create " << zoomDir << std::endl;
+            return false;
+        }
+    }
+    
+    std::atomic<unsigned> failCnt(0);
+    for (unsigned yTile = 0; yTile < yTiles; yTile++) {
+        for (unsigned xTile = 0; xTile < xTiles; xTile++) {
+            pool.add([&, xTile, yTile]() {
+                FImage tile = FImage::Create(tileSize, tileSize, bitsPerPixel);
+                if (bitsPerPixel == 8) {
+                    tile.setPalette(palette);
+                    for (unsigned row = 0; row < tileSize; row++) {
+                        memset(tile.ScanLine(row), clearIdx, tileSize);
+                    }
+                } else {
+                    tile.FillImage(FColor::TRANSPARENT);
+                }
+                
+                // Scan lines are bottom up, tile rows counted from top.
+                unsigned x0 = xTile * tileSize;
+                unsigned copyBytes = std::min(tileSize, width - x0) * bytesPerPixel;
+                for (unsigned row = 0; row < tileSize && yTile * tileSize + row < height; row++) {
+                    const BYTE* inRow = img.ReadScanLine(height - 1 - (yTile * tileSize + row));
+                    BYTE* outRow = tile.ScanLine(tileSize - 1 - row);
+                    memcpy(outRow, inRow + x0 * bytesPerPixel, copyBytes);
+                }
+                
+                lstring tileName(zoomDir);
+                tileName += Directory_files::SLASH;
+                tileName += std::to_string(xTile);
+                tileName += Directory_files::SLASH;
+                tileName += std::to_string(yTile);
+                tileName += ".png";
+                if (!ImageUtilF::saveTo(tile, tileName, false)) {
+                    failCnt++;
+                }
+                tile.Close();
+            });
+        }
+    }
+    pool.wait();
+    
+    if (failCnt != 0) {
+        std::cerr << "Pyramid failed to save " << failCnt << " tiles in " << zoomDir << std::endl;
+    }
+    return failCnt == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Half size 8bit image, output pixel is most common index of its 2x2 block (first wins ties),
+// so no colors outside the palette are created.  Row bands run on the pool.
+FImage FPyramid::HalfI8(const FImage& inI8, TaskPool& pool) {
+    unsigned width = inI8.GetWidth();
+    unsigned height = inI8.GetHeight();
+    unsigned outWidth = (width + 1) / 2;
+    unsigned outHeight = (height + 1) / 2;
+    
+    FImage outI8 = FImage::Create(outWidth, outHeight, 8);
+    FPalette palette;
+    outI8.setPalette(inI8.getPalette(palette));
+    
+    unsigned bands = std::min(pool.size() * 4, outHeight);
+    for (unsigned band = 0; band < bands; band++) {
+        pool.add([&, band]() {
+            for (unsigned outY = band * outHeight / bands; outY < (band + 1) * outHeight / bands; outY++) {
+                // Pair rows from top, clamp odd last row.
+                unsigned topY = 2 * outY;
+                unsigned botY = std::min(topY + 1, height - 1);
+                const BYTE* inRow1 = inI8.ReadScanLine(height - 1 - topY);
+                const BYTE* inRow2 = inI8.ReadScanLine(height - 1 - botY);
+                BYTE* outRow = outI8.ScanLine(outHeight - 1 - outY);
+                for (unsigned outX = 0; outX < outWidth; outX++) {
+                    unsigned x1 = 2 * outX;
+                    unsigned x2 = std::min(x1 + 1, width - 1);
+                    const BYTE px[4] = { inRow1[x1], inRow1[x2], inRow2[x1], inRow2[x2] };
+                    BYTE bestPx = px[0];
+                    unsigned bestCnt = 0;
+                    for (unsigned i = 0; i < 4; i++) {
+                        unsigned cnt = (px[0] == px[i]) + (px[1] == px[i]) + (px[2] == px[i]) + (px[3] == px[i]);
+                        if (cnt > bestCnt) {
+                            bestCnt = cnt;
+                            bestPx = px[i];
+                        }
+                    }
+                    outRow[outX] = bestPx;
+                }
+            }
+        });
+    }
+    pool.wait();
+    return outI8;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Half size 32bit image, color channels averaged weighted by alpha (premultiplied)
+// so transparent pixels do not darken edges.  Row bands run on the pool.
+FImage FPyramid::HalfP32(const FImage& inP32, TaskPool& pool) {
+    unsigned width = inP32.GetWidth();
+    unsigned height = inP32.GetHeight();
+    unsigned outWidth = (width + 1) / 2;
+    unsigned outHeight = (height + 1) / 2;
+    
+    FImage outP32 = FImage::Create(outWidth, outHeight, 32);
+    
+    unsigned bands = std::min(pool.size() * 4, outHeight);
+    for (unsigned band = 0; band < bands; band++) {
+        pool.add([&, band]() {
+            for (unsigned outY = band * outHeight / bands; outY < (band + 1) * outHeight / bands; outY++) {
+                unsigned topY = 2 * outY;
+                unsigned botY = std::min(topY + 1, height - 1);
+                const FColor* inRow1 = (const FColor*)inP32.ReadScanLine(height - 1 - topY);
+                const FColor* inRow2 = (const FColor*)inP32.ReadScanLine(height - 1 - botY);
+                FColor* outRow = (FColor*)outP32.ScanLine(outHeight - 1 - outY);
+                for (unsigned outX = 0; outX < outWidth; outX++) {
+                    unsigned x1 = 2 * outX;
+                    unsigned x2 = std::min(x1 + 1, width - 1);
+                    const FColor* px[4] = { &inRow1[x1], &inRow1[x2], &inRow2[x1], &inRow2[x2] };
+                    unsigned alpha = 0, red = 0, green = 0, blue = 0;
+                    for (unsigned i = 0; i < 4; i++) {
+                        unsigned a = px[i]->rgbReserved;
+                        alpha += a;
+                        red += px[i]->rgbRed * a;
+                        green += px[i]->rgbGreen * a;
+                        blue += px[i]->rgbBlue * a;
+                    }
+                    if (alpha == 0) {
+                        outRow[outX] = FColor::TRANSPARENT;
+                    } else {
+                        outRow[outX] = FColor(
+                            (BYTE)((red + alpha/2) / alpha),
+                            (BYTE)((green + alpha/2) / alpha),
+                            (BYTE)((blue + alpha/2) / alpha),
+                            (BYTE)((alpha + 2) / 4));
+                    }
+                }
+            }
+        });
+    }
+    pool.wait();
+    return outP32;
+}
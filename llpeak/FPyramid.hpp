@@ -0,0 +1,59 @@
+//-------------------------------------------------------------------------------------------------
+// File: FPyramid.hpp
+// Desc: Write z/x/y (XYZ web map) tile pyramid of an image.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+// Project files
+#include "FImage.hpp"
+#include "FPalette.hpp"
+#include "TaskPool.hpp"
+#include "ll_stdhdr.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Tile pyramid, level maxZoom is full resolution, each lower level is half size.
+// Tiles saved as <outDir>/<z>/<x>/<y>.png, y=0 is top row.
+class FPyramid {
+public:
+    static
+    bool Save(const FImage& img, const lstring& outDir, unsigned tileSize, unsigned threads = 0, bool verbose = false);
+    
+    // Pyramid directory for an output image,  out/frame.png => out/frame
+    static lstring DirName(const lstring& imagePath);
+    static unsigned MaxZoom(unsigned width, unsigned height, unsigned tileSize);
+    
+    static FImage HalfI8(const FImage& inI8, TaskPool& pool);      // 2x2 mode (most common index)
+    static FImage HalfP32(const FImage& inP32, TaskPool& pool);    // 2x2 premultiplied alpha average
+    
+private:
+    static
+    bool SaveLevel(const FImage& img, const lstring& outDir, unsigned zoom, unsigned tileSize, TaskPool& pool);
+};
@@ -63,6 +63,7 @@
 #endif
 #else
 #include <time.h>
+#include <sys/stat.h>
 #endif
 
 //-------------------------------------------------------------------------------------------------
@@ -149,3 +150,35 @@ bool FileUtil::deleteFile(const char* path) {
 #endif
     return true;
 }
+
+//-------------------------------------------------------------------------------------------------
+// Rename over an existing file, Windows rename() fails when the target exists.
+bool FileUtil::replaceFile(const char* fromPath, const char* toPath) {
+#ifdef HAVE_WIN
+    return MoveFileEx(fromPath, toPath, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(fromPath, toPath) == 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+// Create directory and any missing parent directories.
+bool FileUtil::makeDirs(const lstring& path) {
+    struct stat info;
+    for (size_t pos = path.find_first_of("/\\", 1); ; pos = path.find_first_of("/\\", pos + 1)) {
+        lstring dirPath = path.substr(0, pos);
+        if (stat(dirPath, &info) != 0) {
+#ifdef HAVE_WIN
+            if (CreateDirectory(dirPath, NULL) == 0 && GetLastError() != ERROR_ALREADY_EXISTS) {
+#else
+            if (mkdir(dirPath, 0755) != 0 && errno != EEXIST) {
+#endif
+                std::cerr << strerror(errno) << ", failed to create " << dirPath << std::endl;
+                return false;
+            }
+        }
+        if (pos == std::string::npos)
+            break;
+    }
+    return true;
+}
@@ -42,6 +42,8 @@ class FileUtil {
 public:
     static bool RunCommand(const char* command, DWORD* pExitCode, int waitMsec);
     static bool deleteFile(const char* path);
+    static bool replaceFile(const char* fromPath, const char* toPath);
+    static bool makeDirs(const lstring& path);
     static size_t isWriteableFile(const struct stat& info);
     static lstring& getName(lstring& outName, const lstring& inPath);
     static bool FileMatches(const lstring& inName, const PatternList& patternList, bool emptyResult);
@@ -0,0 +1,106 @@
+//-------------------------------------------------------------------------------------------------
+// File: FrameHash.cpp
+// Desc: Hash of every saved output frame, golden output regression
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "FrameHash.hpp"
+
+// C++
+#include <fstream>
+#include <iomanip>
+
+
+lstring FrameHash::path;
+std::map<lstring, uint64_t> FrameHash::hashes;
+std::mutex FrameHash::mutex;
+
+static const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+//-------------------------------------------------------------------------------------------------
+static uint64_t Fnv1a(uint64_t hash, const BYTE* data, size_t len) {
+    for (size_t idx = 0; idx < len; idx++) {
+        hash ^= data[idx];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Scanline padding is skipped, only pixel bytes are hashed.
+uint64_t FrameHash::hash(const FImage& img) {
+    unsigned bits = img.GetBitsPerPixel();
+    unsigned header[3] = { img.GetWidth(), img.GetHeight(), bits };
+    uint64_t hash = Fnv1a(FNV_OFFSET, (const BYTE*)header, sizeof(header));
+    
+    if (bits <= 8) {
+        const RGBQUAD* palette = FreeImage_GetPalette(img.imgPtr);
+        if (palette != nullptr)
+            hash = Fnv1a(hash, (const BYTE*)palette, FreeImage_GetColorsUsed(img.imgPtr) * sizeof(RGBQUAD));
+        // Palette alpha lives in the transparency table.
+        if (img.IsTransparent()) {
+            unsigned transCount = img.GetTransparencyCount();
+            hash = Fnv1a(hash, (const BYTE*)&transCount, sizeof(transCount));
+            const BYTE* transTable = img.GetTransparencyTable();
+            if (transTable != nullptr)
+                hash = Fnv1a(hash, transTable, transCount);
+        }
+    }
+    size_t rowBytes = ((size_t)img.GetWidth() * bits + 7) / 8;
+    for (unsigned y = 0; y < img.GetHeight(); y++) {
+        hash = Fnv1a(hash, img.ReadScanLine(y), rowBytes);
+    }
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+void FrameHash::add(const FImage& img, const char* name) {
+    uint64_t value = hash(img);
+    std::lock_guard<std::mutex> lock(mutex);
+    hashes[name] = value;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool FrameHash::save() {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << strerror(errno) << ", Failed to write hashes " << path << std::endl;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    out << std::hex << std::setfill('0');
+    for (const auto& item : hashes) {
+        out << std::setw(16) << item.second << "  " << item.first << "\n";
+    }
+    return out.good();
+}
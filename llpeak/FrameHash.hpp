@@ -0,0 +1,58 @@
+//-------------------------------------------------------------------------------------------------
+// File: FrameHash.hpp
+// Desc: Hash of every saved output frame, golden output regression
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "ll_stdhdr.hpp"
+#include "FImage.hpp"
+
+// C++
+#include <map>
+#include <mutex>
+
+
+//-------------------------------------------------------------------------------------------------
+// 64bit FNV-1a hash of decoded pixels (size, bits, palette and scanlines, not file bytes)
+// of each saved output frame. Written sorted by name to -hashes=<file>, one "hash name"
+// per line, so runs can be compared with diff against stored golden hashes.
+class FrameHash {
+public:
+    static lstring path;    // -hashes=<file>, empty = disabled
+    
+    static uint64_t hash(const FImage& img);
+    static void add(const FImage& img, const char* name);
+    static bool save();
+    
+private:
+    static std::map<lstring, uint64_t> hashes;
+    static std::mutex mutex;
+};
@@ -3,42 +3,88 @@
 
 #ifdef USE_THREAD
 #include "ImageUtilF.hpp"
+#include "FPyramid.hpp"
 #include "FPrint.hpp"
+#include "RunStats.hpp"
+#include "Progress.hpp"
+#include "Log.hpp"
 
 RingBuffer<ThreadJob*, 5> saveQueue;
+std::mutex saveQueueLock;   // Queue is shared by all ImageAux (jobs may run in parallel)
+static std::atomic<unsigned> unfinished(0);     // Saves queued or being waited on
 
 //-------------------------------------------------------------------------------------------------
 void ThreadJob::saveImageThreadFnc() {
    // FPrint::printInfo(img, name);
+   if (RunStats::tracing)
+       RunStats::setFrame(name);
+   if (indexPalette != nullptr && img.GetBitsPerPixel() == 32) {
+       img = ImageUtilF::ToIndexed(img, *indexPalette);
+       img.setCategory(FMemory::SAVE_QUEUE);
+   }
    if (ImageUtilF::saveTo(img, name)) {
-       std::cout << "Thread - saved " << name << std::endl;
+       Log::out(Log::DEBUG) << "Thread - saved " << name << std::endl;
    } else {
        std::cerr << "Thread - save FAILED " << name << std::endl;
    }
+   if (pyramidTile != 0 && !FPyramid::Save(img, FPyramid::DirName(name), pyramidTile, threads, verbose)) {
+       std::cerr << "Thread - pyramid FAILED " << name << std::endl;
+   }
    img.Close();
 }
 
 //-------------------------------------------------------------------------------------------------
-bool ThreadJob::StartThread( FImage& img, const char* toName, ImageAux* aux) {
-    ThreadJob* saveAuxPtr;
-    if (saveQueue.Full()) {
+// Remove oldest queued save and wait for it, false if queue empty.
+// Queue lock is not held while waiting, the wait may run other tasks which queue saves.
+static bool FinishOldest(RunStats::Stage stage) {
+    ThreadJob* saveAuxPtr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(saveQueueLock);
+        if (saveQueue.Empty())
+            return false;
         saveQueue.Get(saveAuxPtr);
-        // std::cerr << "Save Queue Full - join thread " << saveAuxPtr->name << std::endl;
-        saveAuxPtr->thread1.join();
-        delete saveAuxPtr;
+        Progress::saveQueued--;
     }
+    StageTimer timer(stage, 0, saveAuxPtr->name);
+    saveAuxPtr->saveTask.wait();
+    delete saveAuxPtr;
+    unfinished--;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool ThreadJob::StartThread( FImage& img, const char* toName, ImageAux* aux) {
+    // Over -max-memory, finish oldest pending saves before queuing another image.
+    while (FMemory::overBudget() && FinishOldest(RunStats::MEM_WAIT)) {
+    }
+    
+    // Save starts now, on the calling thread when -threads=1, so not under the queue lock.
+    img.setCategory(FMemory::SAVE_QUEUE);
+    unfinished++;
+    ThreadJob* saveAuxPtr = (aux != nullptr)
+        ? new ThreadJob(img, toName, aux->verbose, aux->indexPalette, aux->pyramidTile, aux->threads)
+        : new ThreadJob(img, toName);
     
-    saveAuxPtr = new ThreadJob(img, toName, (aux!=nullptr) ? aux->verbose : false);
+    std::unique_lock<std::mutex> lock(saveQueueLock);
+    while (saveQueue.Full()) {
+        lock.unlock();
+        FinishOldest(RunStats::SAVE_WAIT);
+        lock.lock();
+    }
+    Progress::saveQueued++;
     return saveQueue.Put(saveAuxPtr);
 }
 
 //-------------------------------------------------------------------------------------------------
+// Drain queue, then wait for saves other threads removed from the queue.
 void ThreadJob::EndThreads() {
-    ThreadJob* saveAuxPtr;
-    while (!saveQueue.Empty()) {
-        saveQueue.Get(saveAuxPtr);
-        saveAuxPtr->thread1.join();
-        delete saveAuxPtr;
+    for (;;) {
+        if (FinishOldest(RunStats::SAVE_WAIT))
+            continue;
+        if (unfinished == 0)
+            break;
+        if (!Scheduler::get().runOne())
+            std::this_thread::yield();
     }
 }
 #endif
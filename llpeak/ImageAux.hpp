@@ -42,63 +42,74 @@
 #include "ImageCfg.hpp"
 #include "PalMapping.hpp"
 
+// C++
+#include <functional>
+
+// Receives output image instead of saving it (see CmdPipelineF).
+typedef std::function<bool(FImage& img, const lstring& name)> ImageSink;
+
 #define USE_THREAD
 #ifdef USE_THREAD
 #include <atomic>         // std::atomic
-#include <thread>         // std::thread
+#include <mutex>          // std::mutex
 #include <memory>         // unique_ptr
 #include "RingBuffer.hpp"
+#include "TaskPool.hpp"
 
 // Forward declaration
 class ImageAux;
 
 //-------------------------------------------------------------------------------------------------
-// Class to manage saving Images in a thread.
+// Class to manage saving Images as tasks on the shared Scheduler (see TaskPool).
 class ThreadJob {
 public:
     FImage img;
     lstring name;
-    std::thread thread1;
-    bool verbose;
+    const FPalette* indexPalette = nullptr;     // Save as 8bit palette image
+    unsigned pyramidTile = 0;   // Also save tile pyramid of saved image, 0=off
+    unsigned threads = 0;       // Pyramid tile threads, 0=all
+    bool verbose = false;
+    TaskPool saveTask;      // Encode and write, wait() helps run other tasks
     
     ThreadJob()
     { }
-    ThreadJob(FImage& _img, const lstring& _name, bool _verbose = false) :
+    ThreadJob(FImage& _img, const lstring& _name, bool _verbose = false, const FPalette* _indexPalette = nullptr,
+            unsigned _pyramidTile = 0, unsigned _threads = 0) :
         img(_img),
         name(_name),
-        verbose(_verbose),
-        thread1(&ThreadJob::saveImageThreadFnc, this) {
-    }
-    ~ThreadJob()
-    { }
-    ThreadJob& operator=( ThreadJob& other) {
-        if (this != &other) {
-            img = other.img;
-            name = other.name;
-            verbose = other.verbose;
-            thread1.swap(other.thread1);
-        }
-        return *this;
+        indexPalette(_indexPalette),
+        pyramidTile(_pyramidTile),
+        threads(_threads),
+        verbose(_verbose) {
+        saveTask.add([this]() { saveImageThreadFnc(); });
     }
 
-    // Start thread to save image.
+    // Queue image save, waits for oldest pending save when queue is full.
     bool StartThread( FImage& img, const char* toName, ImageAux* aux = nullptr);
-    // Wait for pending threads to complete.
+    // Wait for pending saves to complete.
     void EndThreads();
     
 private:
+    ThreadJob(const ThreadJob&) = delete;
+    ThreadJob& operator=(const ThreadJob&) = delete;
     void saveImageThreadFnc();
 };
 #endif
 
 //-------------------------------------------------------------------------------------------------
 // Auxiliary data used by Image functions.
+// Each command (job) owns its ImageAux, frames of one aux are processed by one thread at a time.
+// Work split across threads gets its own aux with copySettings() (see CmdBlendF::blendChunks).
 class ImageAux {
 public:
-    // General
+    // General, job settings, read only while frames are processed
     bool        verbose = false;
     unsigned    outCnt = 0;
     lstring     outPath;
+    ImageSink   sink;           // When set, output images passed to sink, not saved
+    unsigned    threads = 0;    // Worker threads, 0 = all cores
+    const FPalette* indexPalette = nullptr;     // Save 8bit palette images, fallback colors
+    unsigned    pyramidTile = 0;    // Also save z/x/y tile pyramid of each output (see FPyramid)
     
     // Blend
     FImageRef   overlayImgRef;
@@ -107,6 +118,9 @@ public:
     PalMapping  bottomMap;
     FPalette    bottomPalette;
     bool        doBottom = false;
+    lstring     lastFrame;      // Last blended input, saved with checkpoint
+    bool        keepLastImg = false;
+    FImage      lastImg;        // Copy of last blended input when not on disk
     
     // Shade
     FShadeRef   shadeRef;
@@ -123,6 +137,16 @@ public:
     void init() {
         useThread = true;
     }
+    // Copy job settings, running state (layers, maps) starts empty.
+    void copySettings(const ImageAux& other) {
+        verbose = other.verbose;
+        outPath = other.outPath;
+        sink = other.sink;
+        threads = other.threads;
+        indexPalette = other.indexPalette;
+        pyramidTile = other.pyramidTile;
+        init();
+    }
     // Threading
     void complete() {
         threadSaveImage.EndThreads();
@@ -130,6 +154,14 @@ public:
 #else
     void init()
     {  }
+    void copySettings(const ImageAux& other) {
+        verbose = other.verbose;
+        outPath = other.outPath;
+        sink = other.sink;
+        threads = other.threads;
+        indexPalette = other.indexPalette;
+        pyramidTile = other.pyramidTile;
+    }
     void complete()
     {   }
 #endif
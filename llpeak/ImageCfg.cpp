@@ -192,6 +192,9 @@
      },
      "bottom" : {
          "rgba" : "128,128,128,32"
+     },
+     "colorlapse" : {
+         "min-pixels" : 1
      }
  }
  
@@ -232,6 +235,7 @@ bool ImageCfg::parseConfig(const lstring& cfgName) {
     cfgFilename.replaceStr( "~", getHomeDir()); // Convert ~ to home directory.
     
     isValid = false;
+    palettesReady = false;
     try {
         if (stat(cfgFilename, &filestat) == 0) {
             in.open(cfgFilename);
@@ -260,10 +264,16 @@ bool ImageCfg::parseConfig(const lstring& cfgName) {
                 if (getMapList("bottom", mapList, "rgba")) {
                     bottomCfg.color = FColor(JsonUtil::get(mapList, "rgba", "128,128,128,16"));
                 }
+                if (getMapList("colorlapse", mapList, "min-pixels")) {
+                    colorlapseCfg.minPixels = (unsigned)atoi(JsonUtil::get(mapList, "min-pixels", "1"));
+                }
                 
+                // Resolve palettes now, getters are then read only and safe across threads.
                 isValid = true;
+                getInPalette();
                 getOutPalette();
                 getOverlayPalette();
+                palettesReady = true;
             } else {
                 cerr << "Config Failed to open:" << cfgFilename << endl;
             }
@@ -319,7 +329,7 @@ bool ImageCfg::getMapList(const char* id, JsonMap& mapList, const lstring& valid
 
 //-------------------------------------------------------------------------------------------------
 const FPalette&   ImageCfg::getInPalette()  {
-    if (inPalette.empty() && isValid) {
+    if (!palettesReady && inPalette.empty() && isValid) {
         isValid &= parsePalette("in-palette", inPalette);
     }
     return inPalette;
@@ -327,7 +337,7 @@ const FPalette&   ImageCfg::getInPalette()  {
 
 //-------------------------------------------------------------------------------------------------
 const FPalette&   ImageCfg::getOutPalette()  {
-    if (outPalette.empty() && isValid) {
+    if (!palettesReady && outPalette.empty() && isValid) {
         if (!parsePalette("out-palette", outPalette, &getInPalette())) {
             outPalette = getInPalette();
             isValid &= outPalette.size() > 0;
@@ -338,7 +348,7 @@ const FPalette&   ImageCfg::getOutPalette()  {
 
 //-------------------------------------------------------------------------------------------------
 const FPalette&  ImageCfg::getOverlayPalette()  {
-    if (overlayPalette.empty() && isValid) {
+    if (!palettesReady && overlayPalette.empty() && isValid) {
         isValid &= parsePalette("overlay-palette", overlayPalette, &getOutPalette());
     }
     return overlayPalette;
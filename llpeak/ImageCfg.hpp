@@ -59,6 +59,10 @@ public:
     float    alphaMultiple = 0.99f;   // 0..< 1.0=fade, 1.0=no change, > 1.0 invalid.
     unsigned alphaMinimum = 0;        // 0..255
 };
+class ColorlapseCfg {
+public:
+    unsigned minPixels = 1;           // Skip palette colors used by fewer pixels.
+};
 class BottomCfg {
 public:
     FColor color;
@@ -87,7 +91,9 @@ public:
     std::map<lstring, PixelFilterCfg> overlayFilters;
     OverlayCfg overlayCfg;
     BottomCfg bottomCfg;
+    ColorlapseCfg colorlapseCfg;
     bool isValid;
+    bool palettesReady = false;     // Palettes parsed, getters no longer modify config
    
     enum OverlayOrder { OVER_IMAGE, UNDER_IMAGE };
     OverlayOrder overlayerOrder = UNDER_IMAGE;
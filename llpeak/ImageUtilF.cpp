@@ -39,11 +39,17 @@
 
 // Project files
 #include "ImageUtilF.hpp"
+#include "TaskPool.hpp"
+#include "FPyramid.hpp"
+#include "LruCache.hpp"
 #include "FPrint.hpp"
 #include "FBrush.hpp"
 #include "FDraw.hpp"
 #include "FBlur.hpp"
 #include "FileUtil.hpp"
+#include "RunStats.hpp"
+#include "Progress.hpp"
+#include "FrameHash.hpp"
 
 
 
@@ -53,11 +59,14 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <unordered_map>
 #include <regex>
 #include <sstream>
 #include <vector>
 #include <memory>   // unique_ptr, memset, memcpy
+#include <mutex>    // call_once
 
 // C
 #include <assert.h>
@@ -67,7 +76,7 @@
 #include <stdlib.h>
 
 
-bool ImageUtilF::initDone = false;
+static std::once_flag initOnce;
 
 
 //-------------------------------------------------------------------------------------------------
@@ -92,11 +101,34 @@ myTellProc(fi_handle handle) {
 }
 
 //-------------------------------------------------------------------------------------------------
-FImage& ImageUtilF::LoadImage(FImage& img, const char* fullname) {
+void ImageUtilF::init() {
+    std::call_once(initOnce, []() {
+        // Call this ONLY when linking with FreeImage as a static library
+        FreeImage_Initialise();
+        FreeImage_SetOutputMessage(FreeImageErrorHandler);
+        std::cout << "\n" << FreeImage_GetCopyrightMessage() << "\nFreeImage v" << FreeImage_GetVersion() << std::endl;
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+// Decode image, FIF_LOAD_NOPIXELS reads only header and palette (not counted as input bytes).
+FImage& ImageUtilF::LoadImage(FImage& img, const char* fullname, int flags) {
+    bool pixels = (flags & FIF_LOAD_NOPIXELS) == 0;
+    if (RunStats::tracing && pixels)
+        RunStats::setFrame(fullname);
+    if (pixels)
+        FMemory::waitBudget();      // Stall prefetch while over -max-memory
+    StageTimer timer(RunStats::LOAD);
     FILE* inFile = fopen(fullname, "rb");
 
     if (inFile != NULL) {
         ImageUtilF::init();
+        if (pixels && fseek(inFile, 0, SEEK_END) == 0) {
+            size_t fileBytes = (size_t)ftell(inFile);
+            timer.setBytes(fileBytes);
+            Progress::bytesIn += fileBytes;
+            fseek(inFile, 0, SEEK_SET);
+        }
 
         FreeImageIO io;
         io.read_proc = myReadProc;
@@ -112,7 +144,7 @@ FImage& ImageUtilF::LoadImage(FImage& img, const char* fullname) {
 
         if (fif != FIF_UNKNOWN) {
             // load from the file handle
-            img.LoadFromHandle(fif, &io, (fi_handle)inFile, 0);
+            img.LoadFromHandle(fif, &io, (fi_handle)inFile, flags);
         } else {
             std::cerr << strerror(errno);
             std::cerr << ", Failed to load " << fullname << std::endl;
@@ -177,7 +209,26 @@ bool ImageUtilF::saveTo(const FImage& out, const char* toName, bool verbose) {
     // Get output format from the file name or file extension
     FREE_IMAGE_FORMAT out_fif = FreeImage_GetFIFFromFilename(toName);
     if (out_fif != FIF_UNKNOWN) {
-        okay = FreeImage_Save(out_fif, out.imgPtr, toName, 0);
+        if (!FrameHash::path.empty())
+            FrameHash::add(out, toName);
+        // Encode to memory then write, timed as separate stages.
+        FIMEMORY* memory = FreeImage_OpenMemory();
+        {
+            StageTimer timer(RunStats::ENCODE, (size_t)out.GetBytesPerLine() * out.GetHeight(), toName);
+            okay = memory != nullptr && FreeImage_SaveToMemory(out_fif, out.imgPtr, memory, 0);
+        }
+        BYTE* data = nullptr;
+        DWORD size = 0;
+        if (okay && FreeImage_AcquireMemory(memory, &data, &size)) {
+            StageTimer timer(RunStats::WRITE, size, toName);
+            FILE* outFile = fopen(toName, "wb");
+            okay = outFile != nullptr && fwrite(data, 1, size, outFile) == size;
+            if (outFile != nullptr && fclose(outFile) != 0)
+                okay = false;
+            Progress::bytesOut += size;
+        }
+        if (memory != nullptr)
+            FreeImage_CloseMemory(memory);
         if (verbose) {
             if (okay) {
                 std::cout << "Saved " << toName << std::endl;
@@ -193,19 +244,103 @@ bool ImageUtilF::saveTo(const FImage& out, const char* toName, bool verbose) {
     return okay;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Convert 32bit image to 8bit palette with transparency, exact if at most 256 distinct colors,
+// else pixels mapped to the nearest (DeltaE) fallback palette color.
+FImage ImageUtilF::ToIndexed(const FImage& imgP32, const FPalette& fallbackPalette) {
+    unsigned width = imgP32.GetWidth();
+    unsigned height = imgP32.GetHeight();
+    StageTimer timer(RunStats::CONVERT, (size_t)width * height);
+    FImage outI8 = FImage::Create(width, height, 8);
+    
+    FPalette palette;
+    std::unordered_map<unsigned, BYTE> colorIndex;
+    bool exact = true;
+    for (unsigned y = 0; y < height && exact; y++) {
+        const unsigned* inRow = (const unsigned*)imgP32.ReadScanLine(y);
+        BYTE* outRow = outI8.ScanLine(y);
+        for (unsigned x = 0; x < width; x++) {
+            auto it = colorIndex.find(inRow[x]);
+            if (it != colorIndex.end()) {
+                outRow[x] = it->second;
+            } else if (palette.size() < 256) {
+                const FColor& color = ((const FColor*)inRow)[x];
+                outRow[x] = colorIndex[inRow[x]] = (BYTE)palette.size();
+                palette.push_back(color);
+            } else {
+                exact = false;
+                break;
+            }
+        }
+    }
+    
+    if (!exact) {
+        // Nearest perceptual (LAB + alpha) fallback color, cached per distinct input color.
+        // Long lived fallback palette keeps its search tree between frames.
+        palette = fallbackPalette;
+        if (palette.size() > 256) {
+            palette.resize(256);
+        }
+        const FPalette& lookupPalette = (fallbackPalette.size() <= 256) ? fallbackPalette : palette;
+        colorIndex.clear();
+        for (unsigned y = 0; y < height; y++) {
+            const FColor* inRow = (const FColor*)imgP32.ReadScanLine(y);
+            BYTE* outRow = outI8.ScanLine(y);
+            for (unsigned x = 0; x < width; x++) {
+                const unsigned key = inRow[x].rgba();
+                auto it = colorIndex.find(key);
+                if (it == colorIndex.end()) {
+                    unsigned bestIdx = lookupPalette.findClosestLAB(inRow[x]);
+                    if (bestIdx == FPalette::NO_CLOSEST)
+                        bestIdx = 0;
+                    it = colorIndex.insert(std::make_pair(key, (BYTE)bestIdx)).first;
+                }
+                outRow[x] = it->second;
+            }
+        }
+    }
+    
+    outI8.setPalette(palette);
+    return outI8;
+}
+
 //-------------------------------------------------------------------------------------------------
 bool ImageUtilF::threadSaveAndCloseTo(const FImage& cimg, const char* toName, ImageAux& aux) {
     FImage& img = (FImage&)cimg;
+    if (aux.sink) {
+        bool okay = aux.sink(img, toName);
+        img.Close();
+        return okay;
+    }
 #ifdef USE_THREAD
     if (aux.useThread) {
         return aux.threadSaveImage.StartThread(img, toName, &aux);
     }
 #endif
+    if (aux.indexPalette != nullptr && img.GetBitsPerPixel() == 32) {
+        img = ToIndexed(img, *aux.indexPalette);
+    }
     bool okay = saveTo(img, toName, aux.verbose);
+    if (aux.pyramidTile != 0 && !FPyramid::Save(img, FPyramid::DirName(toName), aux.pyramidTile, aux.threads, aux.verbose)) {
+        std::cerr << "Pyramid FAILED " << toName << std::endl;
+        okay = false;
+    }
     img.Close();
     return okay;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Add color to palette if not already present, return false if palette full (256).
+static bool AddUnique(const FColor& color, std::unordered_map<unsigned, BYTE>& colorIndex, FPalette& palette) {
+    if (colorIndex.find(color.rgba()) != colorIndex.end())
+        return true;
+    if (palette.size() >= 256)
+        return false;
+    colorIndex[color.rgba()] = (BYTE)palette.size();
+    palette.push_back(color);
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 // class used when montaging (merging) collection of image tiles.
 class TileInfo {
@@ -215,7 +350,9 @@ public:
     unsigned colors;
     unsigned bitsPerPixel;
     FREE_IMAGE_COLOR_TYPE type;
-    // FImageRef imgRef;
+    FPalette palette;
+    PalMapping remap;       // Tile palette index to global palette index
+    bool loaded = false;
     lstring name;
     unsigned xTile;
     unsigned yTile;
@@ -223,72 +360,117 @@ public:
 
 //-------------------------------------------------------------------------------------------------
 // Merge multiple imput image tiles into single larger output image.
+// Tiles are decoded and placed on a TaskPool, at most one decoded tile per worker.
+// 8bit tile palettes are unified exactly (RGBA hash) when the union fits in 256 colors,
+// else fallback to nearest color palette merge.
 bool ImageUtilF::Montage(
        const FPalette& inPalette,
        StringList inPaths, int xTiles, int yTiles,
-       const lstring& outputPath) {
+       const lstring& outputPath, unsigned threads, unsigned pyramidTile) {
     bool okay = true;
     
-    FImage outI8;
-    std::vector<TileInfo> imageSet(inPaths.size());
     FPalette outPalette(inPalette);
-    FPalette tilePalette;
+    TaskPool pool(threads);
     
-    unsigned idx = 0;
-    for (const lstring& fullname : inPaths) {
-        FImage img;
-        if (LoadImage(img, fullname).Valid()) {
-            FREE_IMAGE_COLOR_TYPE imgType = img.GetColorType();
-            TileInfo& imgInfo = imageSet[idx];
-            imgInfo.width = img.GetWidth();
-            imgInfo.height = img.GetHeight();
-            imgInfo.colors = img.GetColorsUsed();
-            imgInfo.bitsPerPixel = img.GetBitsPerPixel();
-            imgInfo.type = imgType;
-            imgInfo.name = fullname;
-            imgInfo.xTile = idx % xTiles;
-            imgInfo.yTile = idx / xTiles;
-            
-            if (outPalette.size() == 0) {
-                img.getPalette(outPalette);
+    // Pass 1 - read tile headers and palettes in parallel, pixels are not decoded.
+    std::vector<TileInfo> loadSet(inPaths.size());
+    for (unsigned pathIdx = 0; pathIdx < inPaths.size(); pathIdx++) {
+        pool.add([&inPaths, &loadSet, pathIdx]() {
+            FImage img;
+            if (LoadImage(img, inPaths[pathIdx], FIF_LOAD_NOPIXELS).Valid()) {
+                TileInfo& imgInfo = loadSet[pathIdx];
+                imgInfo.width = img.GetWidth();
+                imgInfo.height = img.GetHeight();
+                imgInfo.colors = img.GetColorsUsed();
+                imgInfo.bitsPerPixel = img.GetBitsPerPixel();
+                imgInfo.type = img.GetColorType();
+                imgInfo.name = inPaths[pathIdx];
+                img.getPalette(imgInfo.palette);
+                imgInfo.loaded = true;
+                img.Close();
             }
-            if (idx != 0) {
-                if (imgInfo.bitsPerPixel != imageSet[0].bitsPerPixel) {
-                    std::cerr << fullname << " has different bpp " <<  imgInfo.bitsPerPixel
-                        << " than first image " << imageSet[0].bitsPerPixel << std::endl;
-                    okay = false;
-                }
-                if (imgInfo.type != imageSet[0].type) {
-                    std::cerr << fullname << " has different type " << FPrint::toString(imgInfo.type)
-                        << " than first image " << FPrint::toString(imageSet[0].type) << std::endl;
-                    okay = false;
-                }
-                if (imgInfo.width != imageSet[0].width) {
-                    std::cerr << fullname << " has different width " << imgInfo.width
-                        << " than first image " << imageSet[0].width << std::endl;
-                    okay = false;
-                }
-                if (imgInfo.height != imageSet[0].height) {
-                    std::cerr << fullname << " has different height " << imgInfo.height
-                        << " than first image " << imageSet[0].height << std::endl;
-                    okay = false;
+        });
+    }
+    pool.wait();
+    
+    // Validate and merge palettes in input order, only loaded tiles take a position.
+    std::unordered_map<unsigned, BYTE> globalIndex;
+    FPalette unionPalette;
+    bool exact = true;
+    for (const FColor& color : inPalette) {
+        exact = exact && AddUnique(color, globalIndex, unionPalette);
+    }
+    
+    std::vector<TileInfo> imageSet;
+    imageSet.reserve(loadSet.size());
+    for (TileInfo& imgInfo : loadSet) {
+        if (!imgInfo.loaded)
+            continue;
+        
+        unsigned idx = (unsigned)imageSet.size();
+        imgInfo.xTile = idx % xTiles;
+        imgInfo.yTile = idx / xTiles;
+        
+        if (outPalette.size() == 0) {
+            outPalette = imgInfo.palette;
+        }
+        if (idx != 0) {
+            const lstring& fullname = imgInfo.name;
+            if (imgInfo.bitsPerPixel != imageSet[0].bitsPerPixel) {
+                std::cerr << fullname << " has different bpp " <<  imgInfo.bitsPerPixel
+                    << " than first image " << imageSet[0].bitsPerPixel << std::endl;
+                okay = false;
+            }
+            if (imgInfo.type != imageSet[0].type) {
+                std::cerr << fullname << " has different type " << FPrint::toString(imgInfo.type)
+                    << " than first image " << FPrint::toString(imageSet[0].type) << std::endl;
+                okay = false;
+            }
+            if (imgInfo.width != imageSet[0].width) {
+                std::cerr << fullname << " has different width " << imgInfo.width
+                    << " than first image " << imageSet[0].width << std::endl;
+                okay = false;
+            }
+            if (imgInfo.height != imageSet[0].height) {
+                std::cerr << fullname << " has different height " << imgInfo.height
+                    << " than first image " << imageSet[0].height << std::endl;
+                okay = false;
+            }
+        }
+        
+        if (imgInfo.type == FIC_PALETTE && imgInfo.bitsPerPixel == 8) {
+            imgInfo.remap.init();
+            for (unsigned palIdx = 0; exact && palIdx < imgInfo.palette.size() && palIdx < 256; palIdx++) {
+                exact = AddUnique(imgInfo.palette[palIdx], globalIndex, unionPalette);
+                if (exact) {
+                    imgInfo.remap.to[palIdx] = globalIndex[imgInfo.palette[palIdx].rgba()];
+                    imgInfo.remap.shiftCnt += (imgInfo.remap.to[palIdx] != palIdx) ? 1 : 0;
                 }
-                
-                img.getPalette(tilePalette);
-                outPalette.merge(tilePalette);
             }
-            idx++;
-      
-            
-            img.Close();
         }
+        imageSet.push_back(imgInfo);
     }
+    loadSet.clear();
     
     if (!okay || imageSet.empty()) {
         std::cerr << "Montage ignored\n";
         return false;
     }
     
+    exact = exact && !unionPalette.empty();
+    if (exact) {
+        outPalette = unionPalette;
+    } else {
+        if (!unionPalette.empty()) {
+            std::cerr << "Montage palettes exceed 256 colors, using nearest color merge\n";
+        }
+        for (unsigned idx = 1; idx < imageSet.size(); idx++) {
+            outPalette.merge(imageSet[idx].palette);
+        }
+    }
+    for (TileInfo& imgInfo : imageSet) {
+        imgInfo.palette.clear();
+    }
     
     yTiles = (yTiles > 0) ? yTiles : ((unsigned)imageSet.size() + xTiles-1) / xTiles;
     unsigned outWidth = imageSet[0].width * xTiles;
@@ -298,31 +480,38 @@ bool ImageUtilF::Montage(
     unsigned tileHeight = outHeight / yTiles;
   
     unsigned bitsPerPixel = imageSet[0].bitsPerPixel;
-    unsigned tileByteWidth=0;
+    // Copy exact tile bytes, not padded pitch, so neighbor tiles never overlap.
+    unsigned tileByteWidth = (tileWidth * bitsPerPixel + 7) / 8;
     
     FImage* imgPtr = FImage::Allocate(outWidth, outHeight, bitsPerPixel);
     FImageRef outRef(imgPtr);
+    outRef->setCategory(FMemory::MONTAGE);
+    outRef->FillImage(FColor::TRANSPARENT);
+    outRef->setPalette(outPalette);
     
-    bool initOut = true;
-    PalMapping tileMapping;
- 
-    for (TileInfo& imageInfo : imageSet) {
-        FImage imgTile;
-        if (LoadImage(imgTile, imageInfo.name).Valid()) {
-            tileByteWidth = imgTile.GetBytesPerLine();
+    // Pass 2 - decode, remap and place each tile in parallel, tiles own disjoint output bytes.
+    const FPalette& mergedPalette = outPalette;
+    for (unsigned tileIdx = 0; tileIdx < imageSet.size(); tileIdx++) {
+        pool.add([&imageSet, &mergedPalette, &outRef, exact, tileIdx, tileWidth, tileHeight, tileByteWidth]() {
+            const TileInfo& imageInfo = imageSet[tileIdx];
+            FImage imgTile;
+            if (!LoadImage(imgTile, imageInfo.name).Valid())
+                return;
+            imgTile.setCategory(FMemory::MONTAGE);
+            Progress::frameDone();
+            
             bool doMapping = false;
-            if (initOut) {
-                outRef->FillImage(FColor::TRANSPARENT);
-                outRef->setPalette(outPalette);
-                initOut = false;
-            } else {
-                if (imageInfo.type == FIC_PALETTE && imageInfo.bitsPerPixel == 8) {
-                    imgTile.getPalette(tilePalette);
-                    tileMapping = FPalette::getMapping(outPalette, tilePalette);
-                    doMapping = (tileMapping.shiftCnt != 0);
-                }
+            PalMapping tileMapping;
+            if (exact) {
+                tileMapping = imageInfo.remap;
+                doMapping = (tileMapping.shiftCnt != 0);
+            } else if (tileIdx != 0 && imageInfo.type == FIC_PALETTE && imageInfo.bitsPerPixel == 8) {
+                FPalette tilePalette;
+                imgTile.getPalette(tilePalette);
+                tileMapping = FPalette::getMapping(mergedPalette, tilePalette);
+                doMapping = (tileMapping.shiftCnt != 0);
             }
-          
+            
             if (doMapping) {
                 for (unsigned y = 0; y < tileHeight; y++) {
                     const BYTE* inRow = imgTile.ReadScanLine(y);
@@ -341,10 +530,14 @@ bool ImageUtilF::Montage(
             }
             
             imgTile.Close();
-        }
+        });
     }
+    pool.wait();
     
     okay = okay && saveTo(outRef, outputPath, true);
+    if (okay && pyramidTile != 0) {
+        okay = FPyramid::Save(outRef, FPyramid::DirName(outputPath), pyramidTile, threads, true);
+    }
     // outRef->Close();
     return okay;
 }
@@ -432,7 +625,15 @@ FImage& ImageUtilF::BlendI8_P32(const FImage& topImgI8, const FImage& botImgI8,
     FPalette topPalette, botPalette;
     topImgI8.getPalette(topPalette);
     botImgI8.getPalette(botPalette);
-    
+    return BlendI8_P32(topPalette, topImgI8, botPalette, botImgI8, outImgP32);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Index 8bit blended over 8bit using supplied palettes, output to 32bit.
+FImage& ImageUtilF::BlendI8_P32(
+        const FPalette& topPalette, const FImage& topImgI8,
+        const FPalette& botPalette, const FImage& botImgI8,
+        FImage& outImgP32) {
     unsigned widthTop = topImgI8.GetWidth();
     unsigned heightTop = topImgI8.GetHeight();
     unsigned widthBot = botImgI8.GetWidth();
@@ -536,6 +737,7 @@ bool ImageUtilF::ShadeI8(const lstring& fullname, ImageCfg& cfg, ImageAux& aux,
     imgI8.getPalette(inPalette);
   
     if (!aux.shadeMap.isReady) {
+        StageTimer timer(RunStats::MAP);
         const FPalette& outPalette = cfg.getOutPalette();
         FPalette tmpPalette(outPalette);
         tmpPalette.remove(FColor::BLACK).remove(FColor::WHITE).remove(FColor::TRANSPARENT);
@@ -555,7 +757,10 @@ bool ImageUtilF::ShadeI8(const lstring& fullname, ImageCfg& cfg, ImageAux& aux,
     FImage* imgPtrP32 = FImage::Allocate(width, height, 32, 0xff0000, 0xf00, 0xff);
     FImageRef imgP32(imgPtrP32);
     
-    aux.shadeRef->shadeI8_P32(inPalette, imgI8, imgP32, cfg, aux);
+    {
+        StageTimer timer(RunStats::KERNEL, (size_t)width * height * 4);
+        aux.shadeRef->shadeI8_P32(inPalette, imgI8, imgP32, cfg, aux);
+    }
     
     ImageUtilF::threadSaveAndCloseTo(imgP32, aux.outPath + outNameExtn, aux);
     // imgP32->Close();
@@ -572,7 +777,10 @@ bool ImageUtilF::ShadeP32(const lstring& fullname, ImageCfg& cfg, ImageAux& aux,
     lstring outNameExtn;
     FileUtil::getName(outNameExtn, fullPath);
     
-    aux.shadeRef->shadeP32(imgP32, imgP32, cfg, aux);
+    {
+        StageTimer timer(RunStats::KERNEL, (size_t)imgP32.GetBytesPerLine() * imgP32.GetHeight());
+        aux.shadeRef->shadeP32(imgP32, imgP32, cfg, aux);
+    }
     ImageUtilF::threadSaveAndCloseTo(imgP32, aux.outPath + outNameExtn, aux);
 
     return true;
@@ -583,24 +791,28 @@ bool ImageUtilF::ShadeP32(const lstring& fullname, ImageCfg& cfg, ImageAux& aux,
 bool ImageUtilF::Shade(const lstring& fullname, ImageCfg& cfg, ImageAux& aux) {
     FImage img;
     if (cfg.isValid &&  LoadImage(img, fullname).Valid()) {
-        
-        unsigned bitsPerPixel = img.GetBitsPerPixel();
-        switch (bitsPerPixel) {
-            case 8:
-                return ShadeI8(fullname, cfg, aux, img);
-            case 32:
-                return ShadeP32(fullname, cfg, aux, img);
-                break;
-            default:
-                std::cerr << "Unsupported bit depth, must be 8 or 32 not " << bitsPerPixel << std::endl;
-                return false;
-        }
+        return Shade(fullname, cfg, aux, img);
     } else {
         std::cerr << "Shade failed bad cfg or failed to open " << fullname << std::endl;
         return false;
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// Shade already loaded image.
+bool ImageUtilF::Shade(const lstring& fullname, ImageCfg& cfg, ImageAux& aux, FImage& img) {
+    unsigned bitsPerPixel = img.GetBitsPerPixel();
+    switch (bitsPerPixel) {
+        case 8:
+            return ShadeI8(fullname, cfg, aux, img);
+        case 32:
+            return ShadeP32(fullname, cfg, aux, img);
+        default:
+            std::cerr << "Unsupported bit depth, must be 8 or 32 not " << bitsPerPixel << std::endl;
+            return false;
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 bool ImageUtilF::BlurI8(const lstring& fullname, ImageCfg& cfg, ImageAux& aux, const FImage& inI8) {
     lstring fullPath(fullname);
@@ -614,9 +826,15 @@ bool ImageUtilF::BlurI8(const lstring& fullname, ImageCfg& cfg, ImageAux& aux, c
     const FPalette& outPalette = cfg.getOutPalette();
     unsigned radius = 2;
     
+    StageTimer mapTimer(RunStats::MAP);
     PalMapping mapping = FPalette::getMapping(inPalette, outPalette);
+    mapTimer.stop();
+    
     FImage outP32 = FImage::Create(width, height);
-    FBlur::blurI8(mapping, outPalette, inI8, outP32, cfg, aux, radius);
+    {
+        StageTimer timer(RunStats::KERNEL, (size_t)width * height * 4);
+        FBlur::blurI8(mapping, outPalette, inI8, outP32, cfg, aux, radius);
+    }
 
     ImageUtilF::threadSaveAndCloseTo(outP32, aux.outPath + outNameExtn, aux);
     return true;
@@ -630,38 +848,66 @@ bool ImageUtilF::Blur(const lstring& fullname, ImageCfg& cfg, ImageAux& aux) {
         // && MakeTestI8(img, 300, 300, cfg).Valid()
         && LoadImage(img, fullname).Valid()
         ) {
-        
-        unsigned bitsPerPixel = img.GetBitsPerPixel();
-        switch (bitsPerPixel) {
-            case 8:
-                return BlurI8(fullname, cfg, aux, img);
-            case 32:
-            default:
-                std::cerr << "Unsupported bit depth, must be 8 not " << bitsPerPixel << std::endl;
-                return false;
-        }
+        return Blur(fullname, cfg, aux, img);
     } else {
         std::cerr << "Blur failed bad cfg or failed to open " << fullname << std::endl;
         return false;
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// Blur already loaded image.
+bool ImageUtilF::Blur(const lstring& fullname, ImageCfg& cfg, ImageAux& aux, FImage& img) {
+    unsigned bitsPerPixel = img.GetBitsPerPixel();
+    switch (bitsPerPixel) {
+        case 8:
+            return BlurI8(fullname, cfg, aux, img);
+        case 32:
+        default:
+            std::cerr << "Unsupported bit depth, must be 8 not " << bitsPerPixel << std::endl;
+            return false;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Cached MapColors matches (image slot, mapped color), palettes kept to reject hash collisions.
+class MapColorsEntry {
+public:
+    FPalette imgPal;
+    FPalette refPal;
+    FPalette mapPal;
+    std::vector<std::pair<unsigned, FColor>> matches;
+};
+static LruCache<size_t, MapColorsEntry> mapColorsCache(32);
 
 //-------------------------------------------------------------------------------------------------
 // Find image color in reference palette and copy matched slot from mapping color to output
 static unsigned  MapColors(const FPalette& imgPal, const FPalette& refPal, const FPalette& mapPal, FPalette& outPal) {
-    unsigned matchCnt = 0;
-    // outPal = imgPal;
+    size_t key = (imgPal.hash() * 31 + refPal.hash()) * 31 + mapPal.hash();
+    MapColorsEntry entry;
+    if (!mapColorsCache.Get(key, entry) || !entry.imgPal.same(imgPal)
+            || !entry.refPal.same(refPal) || !entry.mapPal.same(mapPal)) {
+        entry.imgPal = imgPal;
+        entry.refPal = refPal;
+        entry.mapPal = mapPal;
+        entry.matches.clear();
+        for (unsigned idx = 0; idx < imgPal.size(); idx++) {
+            unsigned matchIdx = refPal.findColor(imgPal[idx]);
+            if (matchIdx != FPalette::NO_MATCH) {
+                entry.matches.push_back(std::make_pair(idx, mapPal[matchIdx]));
+            }
+        }
+        mapColorsCache.Put(key, entry);
+    }
     
-    for (int idx = 0; idx < imgPal.size(); idx++) {
-        const FColor& imgColor = imgPal[idx];
-        unsigned matchIdx = refPal.findColor(imgColor);
-        if (matchIdx != FPalette::NO_MATCH && outPal[idx] != mapPal[matchIdx]) {
-            outPal[idx] = mapPal[matchIdx];
+    unsigned matchCnt = 0;
+    for (const auto& match : entry.matches) {
+        if (outPal[match.first] != match.second) {
+            outPal[match.first] = match.second;
             matchCnt++;
         }
     }
-    
     return matchCnt;
 }
 
@@ -674,7 +920,13 @@ bool ImageUtilF::BlendFade(const lstring& fullname, unsigned extraFrames, ImageC
     }
     
     FImage imgI8;
-    if (LoadImage(imgI8, fullname).Valid()) {
+    if (aux.lastImg.Valid()) {
+        imgI8 = aux.lastImg;
+        aux.lastImg.Close();
+    } else {
+        LoadImage(imgI8, fullname);
+    }
+    if (imgI8.Valid()) {
         lstring fullPath(fullname);
         lstring outFname;
         FileUtil::getName(outFname, fullPath);
@@ -701,16 +953,23 @@ bool ImageUtilF::BlendFade(const lstring& fullname, unsigned extraFrames, ImageC
         float alphaMultiple = cfg.overlayCfg.alphaMultiple;
         char outName[256];
         
+        const size_t bytesP32 = (size_t)imgI8.GetWidth() * imgI8.GetHeight() * 4;
+        
+        StageTimer mapTimer(RunStats::MAP);
         FPalette srcPalette;
         imgI8.getPalette(srcPalette);
         if (MapColors(srcPalette, cfg.getInPalette(), cfg.getOutPalette(), srcPalette) != 0) {
             imgI8.setPalette(srcPalette);
         }
         imgI8.SetBackgroundColor(FColor::TRANSPARENT);
+        mapTimer.stop();
         
         for (unsigned frameIdx = 0; frameIdx < extraFrames; frameIdx++) {
+            StageTimer convertTimer(RunStats::CONVERT, bytesP32);
             FImage imgP32 = imgI8.ConvertTo32Bits();
+            convertTimer.stop();
             
+            StageTimer kernelTimer(RunStats::KERNEL, bytesP32);
             aux.overlayImgRef->AdjustAlphaP32(alphaMultiple);
             BYTE alpha = FColor::clamp(255 * alphaMultiple * (extraFrames - frameIdx)/extraFrames);
             aux.overlayImgRef->MinAlphaP32(alpha);
@@ -721,22 +980,26 @@ bool ImageUtilF::BlendFade(const lstring& fullname, unsigned extraFrames, ImageC
             //    aux.bottomImgRef->MinAlphaI8(alpha);
                 ImageUtilF::BlendP32_I8(imgP32, aux.bottomImgRef, imgP32);
             }
+            kernelTimer.stop();
             
             snprintf(outName, sizeof(outName), "%s-%03d.%s", fname.c_str(), frameIdx, extn.c_str());
             
-            ImageUtilF::threadSaveAndCloseTo(imgP32, outName, aux);
+            ImageUtilF::threadSaveAndCloseTo(imgP32, aux.outPath + outName, aux);
             // imgP32.Close();
         }
         
         // Save last Fade frame with no overlay and background 50% reduced.
+        StageTimer convertTimer(RunStats::CONVERT, bytesP32);
         FImage imgP32 = imgI8.ConvertTo32Bits();
+        convertTimer.stop();
         if (aux.doBottom) {
+            StageTimer timer(RunStats::KERNEL, bytesP32);
             BYTE alpha = FColor::clamp(cfg.bottomCfg.color.rgbReserved/2);
             aux.bottomImgRef->MinAlphaI8(alpha);
             ImageUtilF::BlendP32_I8(imgP32, aux.bottomImgRef, imgP32);
         }
         snprintf(outName, sizeof(outName), "%s-%03d.%s", fname.c_str(), extraFrames, extn.c_str());
-        ImageUtilF::threadSaveAndCloseTo(imgP32, outName, aux);
+        ImageUtilF::threadSaveAndCloseTo(imgP32, aux.outPath + outName, aux);
         // imgP32.Close();
         
         imgI8.Close();
@@ -745,6 +1008,21 @@ bool ImageUtilF::BlendFade(const lstring& fullname, unsigned extraFrames, ImageC
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Create/update Blend bottom coverage layer, keeps maximum pixel index.
+static void UpdateBottom(ImageAux& aux, FImage& img, unsigned width, unsigned height) {
+    if (aux.bottomImgRef == nullptr) {
+        FImage* imgPtrI8 = FImage::Allocate(width, height, 8, 0xff0000, 0xf00, 0xff);
+        FImageRef imgRef(imgPtrI8);
+        aux.bottomImgRef.swap(imgRef);
+        aux.bottomImgRef->setCategory(FMemory::OVERLAY);
+        aux.bottomImgRef->FillImage(FColor::TRANSPARENT);
+        aux.bottomImgRef->setPalette(aux.bottomPalette);
+    }
+    img.setPalette(aux.bottomPalette);
+    ImageUtilF::MaximumI8(img, aux.bottomImgRef);
+}
+
 //-------------------------------------------------------------------------------------------------
 void ImageUtilF::BlendI8(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux, FImage& imgI8) {
     lstring outFname;
@@ -759,15 +1037,21 @@ void ImageUtilF::BlendI8(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux,
 
     const FPalette& dstPalette = cfg.getOutPalette();
     const FPalette& overlayPalette = cfg.getOverlayPalette();
+    const size_t bytesP32 = (size_t)width * height * 4;
 
+    StageTimer mapTimer(RunStats::MAP);
     if (MapColors(srcPalette, cfg.getInPalette(), cfg.getOutPalette(), srcPalette) != 0) {
         imgI8.setPalette(srcPalette);
     }
     imgI8.SetBackgroundColor(FColor::TRANSPARENT);
+    mapTimer.stop();
     
     // --- Step 1 - blend Overlay layer, Image and Bottom layer and save output image frame.
+    StageTimer convertTimer(RunStats::CONVERT, bytesP32);
     FImage imgP32 = imgI8.ConvertTo32Bits();
+    convertTimer.stop();
     if (aux.overlayImgRef != nullptr) {
+        StageTimer timer(RunStats::KERNEL, bytesP32);
         aux.overlayImgRef->AdjustAlphaP32(cfg.overlayCfg.alphaMultiple, cfg.overlayCfg.alphaMinimum);
         switch (cfg.overlayerOrder) {
             case ImageCfg::OVER_IMAGE:
@@ -788,31 +1072,26 @@ void ImageUtilF::BlendI8(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux,
 
     // --- Step 2 - create/update overlay with selected colorized pixels.
     // Source palette can change, always generate new mapping.
+    StageTimer remapTimer(RunStats::MAP);
     aux.overlayMap = FPalette::getMapping(srcPalette, dstPalette);
 
     imgI8.ApplyPaletteIndexMapping(aux.overlayMap.from, aux.overlayMap.to, colors, false);
     imgI8.setPalette(overlayPalette);
+    remapTimer.stop();
     
+    StageTimer kernelTimer(RunStats::KERNEL, bytesP32);
     if (aux.overlayImgRef == nullptr) {
         FImage* imgPtrP32 = FImage::Allocate(width, height, 32, 0xff0000, 0xf00, 0xff);
         FImageRef imgRef(imgPtrP32);
         aux.overlayImgRef.swap(imgRef);
+        aux.overlayImgRef->setCategory(FMemory::OVERLAY);
         aux.overlayImgRef->FillImage(FColor::TRANSPARENT);
     }
     BlendI8_P32(overlayPalette, imgI8, aux.overlayImgRef);
     
     // --- Step 3 - create/update bottom coverage layer.
     if (aux.doBottom) {
-        // Create bottom (coverage) layer
-        if (aux.bottomImgRef == nullptr) {
-            FImage* imgPtrI8 = FImage::Allocate(width, height, 8, 0xff0000, 0xf00, 0xff);
-            FImageRef imgRef(imgPtrI8);
-            aux.bottomImgRef.swap(imgRef);
-            aux.bottomImgRef->FillImage(FColor::TRANSPARENT);
-            aux.bottomImgRef->setPalette(aux.bottomPalette);
-        }
-        imgI8.setPalette(aux.bottomPalette);
-        MaximumI8(imgI8, aux.bottomImgRef);
+        UpdateBottom(aux, imgI8, width, height);
     }
 }
 
@@ -902,22 +1181,14 @@ void ImageUtilF::BlendP32(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux,
         FImage* imgPtrP32 = FImage::Allocate(width, height, 32, 0xff0000, 0xf00, 0xff);
         FImageRef imgRef(imgPtrP32);
         aux.overlayImgRef.swap(imgRef);
+        aux.overlayImgRef->setCategory(FMemory::OVERLAY);
         aux.overlayImgRef->FillImage(FColor::TRANSPARENT);
     }
     BlendP32(imgP32, aux.overlayImgRef, aux.overlayImgRef);
     
     // --- Step 3 - create/update bottom coverage layer.
     if (aux.doBottom) {
-        // Create bottom (coverage) layer
-        if (aux.bottomImgRef == nullptr) {
-            FImage* imgPtrI8 = FImage::Allocate(width, height, 8, 0xff0000, 0xf00, 0xff);
-            FImageRef imgRef(imgPtrI8);
-            aux.bottomImgRef.swap(imgRef);
-            aux.bottomImgRef->FillImage(FColor::TRANSPARENT);
-            aux.bottomImgRef->setPalette(aux.bottomPalette);
-        }
-        imgP32.setPalette(aux.bottomPalette);
-        MaximumI8(imgP32, aux.bottomImgRef);
+        UpdateBottom(aux, imgP32, width, height);
     }
 
 }
@@ -930,84 +1201,333 @@ void ImageUtilF::BlendP32(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux,
 bool ImageUtilF::Blend(const lstring& fullname, ImageCfg& cfg, ImageAux& aux) {
     FImage img;
     if (LoadImage(img, fullname).Valid()) {
-        lstring fullPath(fullname);
-     
-        unsigned bitsPerPixel = img.GetBitsPerPixel();
-        switch (bitsPerPixel) {
-            case 8:
-                BlendI8(fullname, cfg, aux, img);
-                break;
-            case 24:
-            case 32:
-                BlendP32(fullname, cfg, aux, img);
-                break;
-            default:
-                // FPrint::printInfo(img, fullname);
-                std::cerr << fullname << " must by 8 bit per pixel for Blend\n";
-                return false;
-        }
-        
+        bool okay = Blend(fullname, cfg, aux, img);
         img.Close();
+        return okay;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Blend already loaded image.
+bool ImageUtilF::Blend(const lstring& fullname, ImageCfg& cfg, ImageAux& aux, FImage& img) {
+    unsigned bitsPerPixel = img.GetBitsPerPixel();
+    if (aux.keepLastImg) {
+        aux.lastImg = img.Clone();  // Blend modifies image, keep original for BlendFade
+    }
+    switch (bitsPerPixel) {
+        case 8:
+            BlendI8(fullname, cfg, aux, img);
+            break;
+        case 24:
+        case 32:
+            BlendP32(fullname, cfg, aux, img);
+            break;
+        default:
+            // FPrint::printInfo(img, fullname);
+            std::cerr << fullname << " must by 8 bit per pixel for Blend\n";
+            return false;
+    }
+    
+    aux.lastFrame = fullname;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Only update Blend bottom coverage layer, same pixels as Blend step 3 without any output.
+// Used to compute coverage ahead of time when Blend runs in parallel chunks.
+bool ImageUtilF::BlendBottom(const lstring& fullname, ImageCfg& cfg, ImageAux& aux) {
+    FImage img;
+    if (!LoadImage(img, fullname).Valid()) {
+        return true;
     }
+    
+    unsigned width = img.GetWidth();
+    unsigned height = img.GetHeight();
+    switch (img.GetBitsPerPixel()) {
+        case 8: {
+            unsigned colors = img.GetColorsUsed();
+            FPalette srcPalette;
+            img.getPalette(srcPalette);
+            MapColors(srcPalette, cfg.getInPalette(), cfg.getOutPalette(), srcPalette);
+            PalMapping mapping = FPalette::getMapping(srcPalette, cfg.getOutPalette());
+            img.ApplyPaletteIndexMapping(mapping.from, mapping.to, colors, false);
+            UpdateBottom(aux, img, width, height);
+            break;
+        }
+        case 24:
+        case 32: {
+            FImage imgP32 = img.ConvertTo32Bits();
+            FImage imgOut = imgP32.Clone();
+            FilterImage(imgOut, imgP32);
+            UpdateBottom(aux, imgP32, width, height);
+            break;
+        }
+        default:
+            return false;
+    }
+    return true;
+}
 
+//-------------------------------------------------------------------------------------------------
+// Json string value, escape quote and backslash (Windows paths).
+static lstring JsonEscape(const lstring& value) {
+    lstring str(value);
+    for (size_t pos = 0; (pos = str.find_first_of("\"\\", pos)) != lstring::npos; pos += 2)
+        str.insert(pos, 1, '\\');
+    return str;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Fields of a saved checkpoint, false if missing or poorly formed.
+static bool ReadCheckpoint(const lstring& checkpointPath, MapList& mapList, bool report) {
+    struct stat filestat;
+    std::ifstream in(checkpointPath);
+    if (stat(checkpointPath, &filestat) != 0 || !in.good()) {
+        if (report)
+            std::cerr << "Checkpoint missing or bad path:" << checkpointPath << std::endl;
+        return false;
+    }
+    
+    JsonBuffer buffer;
+    buffer.resize(filestat.st_size + 1);
+    in.read(buffer.data(), filestat.st_size);
+    in.close();
+    buffer.push_back('\0');
+    
+    JsonFields fields;
+    JsonUtil::parseJson(buffer, fields);
+    const JsonBase* jPtr = fields.at("");
+    if (jPtr == nullptr) {
+        if (report)
+            std::cerr << "Checkpoint poorly formed " << checkpointPath << std::endl;
+        return false;
+    }
+    StringList keys;
+    jPtr->toMapList(mapList, keys);
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Save Blend accumulation state (overlay, bottom layers and last frame) so a later run can resume.
+// Layers are written under new generation names (<base>-overlay.<gen>.png) which only the json
+// references. Renaming the json over the prior one commits the save, then the prior generation's
+// layers are removed, so an interrupted save leaves the prior checkpoint whole.
+bool ImageUtilF::SaveCheckpoint(const lstring& checkpointPath, const ImageAux& aux) {
+    MapList prior;
+    bool hasPrior = ReadCheckpoint(checkpointPath, prior, false);
+    unsigned generation = hasPrior
+        ? (unsigned)strtoul(JsonUtil::get(prior, "generation", "0"), nullptr, 10) + 1 : 1;
+    
+    lstring basePath;
+    DirUtil::removeExtn(basePath, checkpointPath);
+    lstring genExtn = "." + std::to_string(generation) + ".png";
+    lstring overlayPath = (aux.overlayImgRef != nullptr) ? basePath + "-overlay" + genExtn : "";
+    lstring bottomPath = (aux.bottomImgRef != nullptr) ? basePath + "-bottom" + genExtn : "";
+    
+    bool okay = true;
+    if (!overlayPath.empty()) {
+        okay &= saveTo(aux.overlayImgRef, overlayPath);
+    }
+    if (!bottomPath.empty()) {
+        okay &= saveTo(aux.bottomImgRef, bottomPath);
+    }
+    
+    lstring tmpPath = checkpointPath + ".tmp";
+    if (okay) {
+        std::ofstream out(tmpPath);
+        out << "{\n"
+            << "    \"generation\" : " << generation << ",\n"
+            << "    \"last-frame\" : \"" << JsonEscape(aux.lastFrame) << "\",\n"
+            << "    \"overlay\" : \"" << JsonEscape(overlayPath) << "\",\n"
+            << "    \"bottom\" : \"" << JsonEscape(bottomPath) << "\"\n"
+            << "}\n";
+        out.close();
+        okay = out.good() && FileUtil::replaceFile(tmpPath, checkpointPath);
+    }
+    
+    if (okay) {
+        if (hasPrior) {
+            for (const char* layer : { "overlay", "bottom" }) {
+                lstring priorPath = JsonUtil::get(prior, layer, "");
+                if (!priorPath.empty() && priorPath != overlayPath && priorPath != bottomPath)
+                    FileUtil::deleteFile(priorPath);
+            }
+        }
+        std::cout << "Checkpoint saved " << checkpointPath << " last frame " << aux.lastFrame << std::endl;
+    } else {
+        std::cerr << strerror(errno) << ", Failed to save checkpoint " << checkpointPath << std::endl;
+        if (!overlayPath.empty())
+            FileUtil::deleteFile(overlayPath);
+        if (!bottomPath.empty())
+            FileUtil::deleteFile(bottomPath);
+    }
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Restore Blend accumulation state saved by SaveCheckpoint.
+bool ImageUtilF::LoadCheckpoint(const lstring& checkpointPath, ImageAux& aux) {
+    MapList mapList;
+    if (!ReadCheckpoint(checkpointPath, mapList, true)) {
+        return false;
+    }
+    
+    bool okay = true;
+    lstring overlayPath = JsonUtil::get(mapList, "overlay", "");
+    if (!overlayPath.empty()) {
+        FImage img;
+        if (LoadImage(img, overlayPath).Valid()) {
+            FImageRef imgRef(new FImage(img.GetBitsPerPixel() == 32 ? img : img.ConvertTo32Bits()));
+            aux.overlayImgRef.swap(imgRef);
+            aux.overlayImgRef->setCategory(FMemory::OVERLAY);
+        } else {
+            okay = false;
+        }
+    }
+    lstring bottomPath = JsonUtil::get(mapList, "bottom", "");
+    if (!bottomPath.empty()) {
+        FImage img;
+        if (LoadImage(img, bottomPath).Valid() && img.GetBitsPerPixel() == 8) {
+            FImageRef imgRef(new FImage(img));
+            aux.bottomImgRef.swap(imgRef);
+            aux.bottomImgRef->setCategory(FMemory::OVERLAY);
+            if (!aux.bottomPalette.empty()) {
+                aux.bottomImgRef->setPalette(aux.bottomPalette);
+            }
+        } else {
+            okay = false;
+        }
+    }
+    
+    if (okay) {
+        aux.lastFrame = JsonUtil::get(mapList, "last-frame", "");
+        std::cout << "Checkpoint resumed " << checkpointPath << " last frame " << aux.lastFrame << std::endl;
+    } else {
+        std::cerr << "Failed to load checkpoint layers " << checkpointPath << std::endl;
+    }
+    return okay;
+}
+
 //-------------------------------------------------------------------------------------------------
 bool ImageUtilF::ToGray(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux) {
+    bool okay = false;
+    FImage imgP32;
+    if (LoadImage(imgP32, fullPath).Valid()) {
+        okay = ToGray(fullPath, cfg, aux, imgP32);
+        imgP32.Close();
+    }
+    return okay;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Convert already loaded 32bit gray image.
+bool ImageUtilF::ToGray(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux, FImage& imgP32) {
     lstring nameExtn;
     FileUtil::getName(nameExtn, fullPath);
 
     bool okay = false;
-    FImage imgP32;
-    if (LoadImage(imgP32, fullPath).Valid()) {
-        unsigned width = imgP32.GetWidth();
-        unsigned height = imgP32.GetHeight();
+    unsigned width = imgP32.GetWidth();
+    unsigned height = imgP32.GetHeight();
+    
+    unsigned bpp = imgP32.GetBitsPerPixel();
+    if (bpp == 32) {
+        FImage outI8 = FImage::Create( width,  height, 8);
+        outI8.SetTransparent(true);
+        outI8.setPalette(cfg.getOutPalette());
+       
+        FREE_IMAGE_COLOR_TYPE clrType = outI8.GetColorType();
+        if (clrType != FIC_PALETTE && clrType != FIC_MINISBLACK) {
+            std::cerr << FPrint::toString(clrType) << ", Unable to make 8bit palette output image \n";
+            return false;
+        }
         
-        unsigned bpp = imgP32.GetBitsPerPixel();
-        if (bpp == 32) {
-            FImage outI8 = FImage::Create( width,  height, 8);
-            outI8.SetTransparent(true);
-            outI8.setPalette(cfg.getOutPalette());
-           
-            FREE_IMAGE_COLOR_TYPE clrType = outI8.GetColorType();
-            if (clrType != FIC_PALETTE && clrType != FIC_MINISBLACK) {
-                std::cerr << FPrint::toString(clrType) << ", Unable to make 8bit palette output image \n";
-                return false;
-            }
-            
-            FPalette outPalette = cfg.getOutPalette();
-            outI8.setPalette(outPalette);
-             
-            outPalette.clear();
-            for (unsigned clr = 0; clr < 256; clr++) {
-                unsigned alpha = std::min(255u, clr*2);
-                outPalette.push_back(FColor(clr, clr, clr, alpha));
-            }
-            outPalette[0] = FColor::TRANSPARENT;
-            
-            for (unsigned y = 0; y < height; y++) {
-                const FColor* inRow = (const FColor*)imgP32.ReadScanLine( y);
-                BYTE* outRow = outI8.ScanLine(y);
-                for (unsigned x = 0; x < width; x++) {
-                    const FColor& inColor = inRow[x];
-                    // TODO - confirm color is gray
-                    // TODO - map to output palette
-                    outRow[x] = inColor.rgbRed;
-                    // outPalette[x] = inColor;
-                }
+        FPalette outPalette = cfg.getOutPalette();
+        outI8.setPalette(outPalette);
+         
+        outPalette.clear();
+        for (unsigned clr = 0; clr < 256; clr++) {
+            unsigned alpha = std::min(255u, clr*2);
+            outPalette.push_back(FColor(clr, clr, clr, alpha));
+        }
+        outPalette[0] = FColor::TRANSPARENT;
+        
+        StageTimer timer(RunStats::CONVERT, (size_t)width * height);
+        for (unsigned y = 0; y < height; y++) {
+            const FColor* inRow = (const FColor*)imgP32.ReadScanLine( y);
+            BYTE* outRow = outI8.ScanLine(y);
+            for (unsigned x = 0; x < width; x++) {
+                const FColor& inColor = inRow[x];
+                // TODO - confirm color is gray
+                // Ramp index is the gray level, so no findClosestLAB search, a LAB plus alpha
+                // match would trade level for the ramp's alpha.
+                outRow[x] = inColor.rgbRed;
+                // outPalette[x] = inColor;
             }
-            
-            // outPalette[0] = FColor::TRANSPARENT;
-            outI8.setPalette(outPalette);
-            okay = threadSaveAndCloseTo(outI8, aux.outPath + nameExtn, aux);
         }
-        imgP32.Close();
+        
+        timer.stop();
+        
+        // outPalette[0] = FColor::TRANSPARENT;
+        outI8.setPalette(outPalette);
+        okay = threadSaveAndCloseTo(outI8, aux.outPath + nameExtn, aux);
     }
     return okay;
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Distinct (top, bottom) pixel index pairs of two 8bit images, each pixel holds its pair id.
+// Blending top over bottom then only needs one color per pair and a gather.
+class IndexPairs {
+public:
+    typedef std::pair<BYTE, BYTE> IndexPair;
+    unsigned width;
+    unsigned height;
+    std::vector<IndexPair> pairs;
+    std::vector<unsigned> pixelPairs;   // Pair id per pixel, width*height, up to 256*256 ids
+    
+    IndexPairs(const FImage& topImgI8, const FImage& botImgI8) :
+        width(std::min(topImgI8.GetWidth(), botImgI8.GetWidth())),
+        height(std::min(topImgI8.GetHeight(), botImgI8.GetHeight())),
+        pixelPairs(width * height) {
+        const unsigned NO_PAIR = ~0u;
+        std::vector<unsigned> pairIds(256 * 256, NO_PAIR);
+        unsigned* pairPtr = pixelPairs.data();
+        for (unsigned y = 0; y < height; y++) {
+            const BYTE* top = topImgI8.ReadScanLine(y);
+            const BYTE* bot = botImgI8.ReadScanLine(y);
+            for (unsigned x = 0; x < width; x++) {
+                unsigned& pairId = pairIds[top[x] * 256 + bot[x]];
+                if (pairId == NO_PAIR) {
+                    pairId = (unsigned)pairs.size();
+                    pairs.push_back(IndexPair(top[x], bot[x]));
+                }
+                *pairPtr++ = pairId;
+            }
+        }
+    }
+    
+    // Same output as ImageUtilF::BlendI8_P32 with these palettes.
+    void blend(const FPalette& topPalette, const FPalette& botPalette, FImage& outImgP32) const {
+        std::vector<FColor> pairColors(pairs.size());
+        for (unsigned idx = 0; idx < pairs.size(); idx++) {
+            FColor botColor = botPalette[pairs[idx].second];
+            topPalette[pairs[idx].first].blendOver(botColor);
+            pairColors[idx] = botColor;
+        }
+        
+        const unsigned* pairPtr = pixelPairs.data();
+        for (unsigned y = 0; y < height; y++) {
+            RGBQUAD* out = (RGBQUAD*)outImgP32.ScanLine(y);
+            for (unsigned x = 0; x < width; x++) {
+                out[x] = pairColors[*pairPtr++];
+            }
+        }
+    }
+};
+
 //-------------------------------------------------------------------------------------------------
 void ImageUtilF::ColorlapseI8(const lstring& fullPath, ImageCfg& cfg, ImageAux& aux, FImage& imgI8) {
     lstring nameExtn;
@@ -1030,7 +1550,15 @@ void ImageUtilF::ColorlapseI8(const lstring& fullPath, ImageCfg& cfg, ImageAux&
     unsigned mapCnt = 0;
     BYTE MIN_CLR = 0x10;
     
-    // TODO - compute histogram, ignore rare colors.
+    // Pixels per palette index, colors used by fewer than min-pixels get no frames.
+    unsigned histogram[256] = {0};
+    for (unsigned y = 0; y < height; y++) {
+        const BYTE* row = imgI8.ReadScanLine(y);
+        for (unsigned x = 0; x < width; x++) {
+            histogram[row[x]]++;
+        }
+    }
+    
     for (int idx = 0; idx < srcPalette.size(); idx++) {
         const FColor& srcColor = srcPalette[idx];
         if (srcColor.maxClr() > MIN_CLR) {
@@ -1068,44 +1596,67 @@ void ImageUtilF::ColorlapseI8(const lstring& fullPath, ImageCfg& cfg, ImageAux&
         transparentPtr[idx] = 0;
     }
     
-    // ****
-    // TODO - thread this for-loop
-    // ****
+    // Frames only differ by transparency table, render each on pool with its own table copy.
+    FPalette basePalette;
+    for (unsigned idx = 0; idx < colorCnt; idx++) {
+        basePalette.push_back(FColor(colors[idx], 0));
+    }
+    FPalette clrPalette;
+    aux.colorizeImg.getPalette(clrPalette);
+    IndexPairs indexPairs(imgI8, aux.colorizeImg);
+    
+    typedef std::vector<BYTE> Table;
+    Table table(transparentPtr, transparentPtr + colorCnt);
+    bool tableChanged = false;
+    TaskPool pool(aux.sink ? 1 : aux.threads);     // Sink (pipeline) needs frames in order.
     
     unsigned outIdx = 0;
     for (unsigned idx = 0; idx < outPalette.size(); idx++) {
         // Show palette colors in "output palette" order
         if (outPalMap[idx].size() > 0 && outPalette[idx].rgbReserved != 0 && outPalette[idx].maxClr() > MIN_CLR) {
             UArray& indexes = outPalMap[idx];
+            unsigned pixelCnt = 0;
+            for (unsigned mapIdx = 0; mapIdx < indexes.size(); mapIdx++) {
+                pixelCnt += histogram[indexes[mapIdx]];
+            }
             
             // Alpha blend  63, 127, 191, 255
-            for (unsigned alpha = 63; alpha < 256; alpha += 64) {
+            for (unsigned alpha = 63; alpha < 256 && pixelCnt >= cfg.colorlapseCfg.minPixels; alpha += 64) {
                 for (unsigned mapIdx = 0; mapIdx < indexes.size(); mapIdx++) {
                     unsigned clrIdx = indexes[mapIdx];
                     if (srcPalette[clrIdx].maxClr() > MIN_CLR) {
-                       // colors[clrIdx].rgbReserved = alpha;
-                        transparentPtr[clrIdx] = alpha;
+                        table[clrIdx] = alpha;
                     }
                 }
-                imgI8.SetTransparencyTable(transparentPtr, colorCnt);
                 
-                FImage outP32 = FImage::Create( width,  height, 32);
-                BlendI8_P32(imgI8, aux.colorizeImg, outP32);
                 snprintf(outName, sizeof(outName), "%s-%04d.%s", justname.c_str(), outIdx++, extn.c_str());
-                threadSaveAndCloseTo(outP32, aux.outPath + outName, aux);
-                // ImageUtilF::saveTo(outP32, aux.outPath + outName, true);
-                // outP32.Close();
+                lstring outPath = aux.outPath + outName;
+                pool.add([table, outPath, width, height, &basePalette, &clrPalette, &indexPairs, &aux]() {
+                    FPalette topPalette(basePalette);
+                    for (unsigned clrIdx = 0; clrIdx < table.size(); clrIdx++) {
+                        topPalette[clrIdx].rgbReserved = table[clrIdx];
+                    }
+                    FImage outP32 = FImage::Create( width,  height, 32);
+                    StageTimer timer(RunStats::KERNEL, (size_t)width * height * 4);
+                    indexPairs.blend(topPalette, clrPalette, outP32);
+                    timer.stop();
+                    threadSaveAndCloseTo(outP32, outPath, aux);
+                });
             }
             
             // Restore original alpha
             for (unsigned mapIdx = 0; mapIdx < indexes.size(); mapIdx++) {
                 unsigned clrIdx = indexes[mapIdx];
-                // colors[clrIdx].rgbReserved = srcPalette[clrIdx].rgbReserved;
-                transparentPtr[clrIdx] = srcPalette[clrIdx].rgbReserved;
+                table[clrIdx] = srcPalette[clrIdx].rgbReserved;
             }
-            imgI8.SetTransparencyTable(transparentPtr, colorCnt);
+            tableChanged = true;
         }
     }
+    pool.wait();
+    
+    if (tableChanged) {
+        imgI8.SetTransparencyTable(table.data(), colorCnt);
+    }
     aux.colorizeImg.Close();
     aux.colorizeImg = imgI8;
     // imgI8.Close();
@@ -1116,28 +1667,33 @@ void ImageUtilF::ColorlapseI8(const lstring& fullPath, ImageCfg& cfg, ImageAux&
 bool ImageUtilF::Colorlapse(const lstring& fullname, ImageCfg& cfg, ImageAux& aux) {
     FImage img;
     if (LoadImage(img, fullname).Valid()) {
-        lstring fullPath(fullname);
-     
-        unsigned bitsPerPixel = img.GetBitsPerPixel();
-        switch (bitsPerPixel) {
-            case 8:
-                ColorlapseI8(fullname, cfg, aux, img);
-                break;
-            case 24:
-            case 32:
-                
-            default:
-                // FPrint::printInfo(img, fullname);
-                std::cerr << fullname << " must by 8 bit per pixel for Colorlapse\n";
-                return false;
-        }
-        
+        bool okay = Colorlapse(fullname, cfg, aux, img);
         img.Close();
+        return okay;
     }
 
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Colorlapse already loaded image.
+bool ImageUtilF::Colorlapse(const lstring& fullname, ImageCfg& cfg, ImageAux& aux, FImage& img) {
+    unsigned bitsPerPixel = img.GetBitsPerPixel();
+    switch (bitsPerPixel) {
+        case 8:
+            ColorlapseI8(fullname, cfg, aux, img);
+            break;
+        case 24:
+        case 32:
+            
+        default:
+            // FPrint::printInfo(img, fullname);
+            std::cerr << fullname << " must by 8 bit per pixel for Colorlapse\n";
+            return false;
+    }
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 //  DLL_CALLCONV
 bool DLL_CALLCONV DrawPixelI8(void* imgPtr, unsigned x, unsigned y, BYTE value)
@@ -1149,8 +1705,9 @@ bool DLL_CALLCONV DrawBoxI8(void* imgPtr, unsigned x1, unsigned y1, unsigned x2,
 }
 
 //-------------------------------------------------------------------------------------------------
-// Save index image palette as a set of images.
-void ImageUtilF::Palette(const lstring& fullname) {
+// Save index image palette as a set of images, <outPath><name>-palette8x8.png ...
+// Names follow the image so concurrent jobs do not overwrite each other.
+void ImageUtilF::Palette(const lstring& fullname, const lstring& outPath) {
     ImageUtilF::init();
 
     FImage imgI8;
@@ -1166,6 +1723,11 @@ void ImageUtilF::Palette(const lstring& fullname) {
         return; // no usable palette
     }
     
+    lstring nameExtn, name;
+    FileUtil::getName(nameExtn, fullname);
+    DirUtil::removeExtn(name, nameExtn);
+    const lstring outBase = outPath + name + "-";
+    
     const unsigned BOX_WIDTH = 32;
     const unsigned BOX_HEIGHT = 32;
 
@@ -1189,7 +1751,7 @@ void ImageUtilF::Palette(const lstring& fullname) {
         paletteImgRef->SetTransparentIndex(0);
         paletteImgRef->setPalette(palette);
 
-        ImageUtilF::saveTo(*paletteImgRef, "paletteH32.png");
+        ImageUtilF::saveTo(*paletteImgRef, outBase + "paletteH32.png");
     }
 
     if (true) {
@@ -1215,15 +1777,15 @@ void ImageUtilF::Palette(const lstring& fullname) {
         paletteImgRef->SetTransparent(true);
         paletteImgRef->SetTransparentIndex(0);
         paletteImgRef->setPalette(palette);
-        ImageUtilF::saveTo(*paletteImgRef, "palette8x8.png");
+        ImageUtilF::saveTo(*paletteImgRef, outBase + "palette8x8.png");
     }
     
     if (true) {
-        saveLegend(palette, "palette256.png");
+        saveLegend(palette, outBase + "palette256.png");
     }
     
     sort(palette.begin(), palette.end(), FPalette::byHSV);
-    saveLegend(palette, "paletteSorted.png");
+    saveLegend(palette, outBase + "paletteSorted.png");
     FPrint::printPalette(palette.quads(), (unsigned)palette.size());
 }
 
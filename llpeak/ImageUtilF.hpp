@@ -56,7 +56,8 @@ class ImageUtilF {
 public:
     static bool saveTo(const FImage& img, const char* toName, bool verbose = false);
     static bool threadSaveAndCloseTo(const FImage& img, const char* toName, ImageAux& aux);
-    static FImage& LoadImage(FImage& img, const char* fullname);
+    static FImage ToIndexed(const FImage& imgP32, const FPalette& fallbackPalette);
+    static FImage& LoadImage(FImage& img, const char* fullname, int flags = 0);
     static FImage& MakeTestI8(FImage& outI8, unsigned width, unsigned height, ImageCfg& cfg);
     
     static void FreeImageErrorHandler(FREE_IMAGE_FORMAT imgFmt, const char *message) {
@@ -67,52 +68,54 @@ public:
         std::cerr << message << std::endl;
     }
     
-    static bool initDone;
-    static void init() {
-        if (!initDone) {
-            // Call this ONLY when linking with FreeImage as a static library
-            FreeImage_Initialise();
-            FreeImage_SetOutputMessage(FreeImageErrorHandler);
-            std::cout << "\n" << FreeImage_GetCopyrightMessage() << "\nFreeImage v" << FreeImage_GetVersion() << std::endl;
-            initDone = true;
-        }
-    }
+    // Initialize FreeImage once, safe to call from any thread.
+    static void init();
     
 
     // Main "Montage" function
-    static bool Montage(const FPalette& inPal, StringList inPaths, int xTiles, int yTiles, const lstring& outputPath);
+    static bool Montage(const FPalette& inPal, StringList inPaths, int xTiles, int yTiles, const lstring& outputPath, unsigned threads = 0, unsigned pyramidTile = 0);
     
     // Main "Dump" function
     static void Dump(const lstring& imagePath);
-    static void Palette(const lstring& imagePath);
+    static void Palette(const lstring& imagePath, const lstring& outPath = "");
     static bool saveLegend(const FPalette& palette, const lstring& outFileName);
 
     // Main "Blur" function
     static bool Blur(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux);
+    static bool Blur(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& img);
     static bool BlurI8(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, const FImage& imgI8);
     
     // Main "Shade" function (must set shade function in ImageAux)
     static bool Shade(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux);
+    static bool Shade(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& img);
     static bool ShadeI8(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& imgI8);
     static bool ShadeP32(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& imgP32);
     
     // Main "ToGray function
     static bool ToGray(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux);
+    static bool ToGray(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& imgP32);
     
     // Main "Colorlapse" function
     static bool Colorlapse(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux);
+    static bool Colorlapse(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& img);
     static void ColorlapseI8(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& imgI8);
     
     // Main "Blend" function.
     static bool Blend(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux);
+    static bool Blend(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& img);
     static bool BlendFade(const lstring& imagePath, unsigned extraFrames, ImageCfg& cfg, ImageAux& aux);
+    static bool BlendBottom(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux);
     // Blend support functions
     static void BlendI8(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& imgI8);
     static void BlendP32(const lstring& imagePath, ImageCfg& cfg, ImageAux& aux, FImage& imgP32);
+    static bool SaveCheckpoint(const lstring& checkpointPath, const ImageAux& aux);
+    static bool LoadCheckpoint(const lstring& checkpointPath, ImageAux& aux);
         
     static FImage& BlendP32(const FImage& topImgP32, const FImage& botImgP32, FImage& outImgP32);
     static FImage& BlendI8_P32(const FPalette& topPalette, const FImage& topImgI8,  FImage& botImgP32);
     static FImage& BlendI8_P32(const FImage& topImgI8, const FImage& botImgI8, FImage& outImgP32);
+    static FImage& BlendI8_P32(const FPalette& topPalette, const FImage& topImgI8,
+            const FPalette& botPalette, const FImage& botImgI8, FImage& outImgP32);
     static FImage& BlendP32_I8(const FImage& topImgP32, const FImage& botImgI8, FImage& outImgP32);
     static FImage& MaximumI8(const FImage& inImgI8, FImage& outImgI8);       // out = max(in, out)
     static unsigned BestMapping(const FPalette& srcPalette, const FPalette& dstPalette, const BYTE* dstMapping, PalMapping& mappings);
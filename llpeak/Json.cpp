@@ -45,12 +45,17 @@
 #endif
 
 //-------------------------------------------------------------------------------------------------
-// Parse json word surrounded by quotes.
+// Parse json word surrounded by quotes, backslash escapes next character (\\ or \").
 void JsonUtil::getJsonWord(JsonBuffer& buffer, char delim, JsonToken& word) {
-    const char* lastPtr = strchr(buffer.ptr(), delim);
+    const char* wordPtr = buffer.ptr();
     word.clear();
-    int len = int(lastPtr - buffer.ptr());
-    word.append(buffer.ptr(len + 1), len);
+    int len = 0;
+    while (wordPtr[len] != '\0' && wordPtr[len] != delim) {
+        if (wordPtr[len] == '\\' && wordPtr[len + 1] != '\0')
+            len++;
+        word += wordPtr[len++];
+    }
+    buffer.ptr(len + 1);
     word.isQuoted = true;
 }
 
@@ -0,0 +1,216 @@
+//-------------------------------------------------------------------------------------------------
+// File: Log.cpp
+// Desc: Asynchronous leveled log sink for std::cout / std::cerr
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "Log.hpp"
+
+// C++
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+
+std::atomic<int> Log::level(Log::INFO);
+Log::Buf* Log::bufs[Log::LEVEL_CNT];
+std::ostream* Log::streams[Log::LEVEL_CNT];
+std::atomic<Log::Node*> Log::head(nullptr);
+Log::Node* Log::tail = nullptr;
+std::streambuf* Log::coutBuf = nullptr;
+std::streambuf* Log::cerrBuf = nullptr;
+
+static std::thread writer;
+static std::mutex wakeMutex;
+static std::condition_variable wake;
+static std::atomic<bool> running(false);
+static const unsigned IDLE_MSEC = 20;       // Writer poll period when idle
+
+//-------------------------------------------------------------------------------------------------
+// Level buffers and streams, usable (synchronous) before start().
+void Log::init() {
+    static std::once_flag done;
+    std::call_once(done, []() {
+        bufs[ERROR] = new Buf(ERROR, stderr);
+        bufs[WARN]  = new Buf(WARN, stderr);
+        bufs[INFO]  = new Buf(INFO, stdout);
+        bufs[DEBUG] = new Buf(DEBUG, stdout);
+        for (int idx = 0; idx < LEVEL_CNT; idx++)
+            streams[idx] = new std::ostream(bufs[idx]);
+        tail = new Node();      // Queue stub
+        tail->next = nullptr;
+        head = tail;
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+void Log::start() {
+    init();
+    if (running)
+        return;
+    std::cout.flush();
+    std::cerr.flush();
+    coutBuf = std::cout.rdbuf(bufs[INFO]);
+    cerrBuf = std::cerr.rdbuf(bufs[ERROR]);
+    running = true;
+    writer = std::thread(&Log::run);
+    
+    static std::once_flag registered;
+    std::call_once(registered, []() { atexit(Log::stop); });
+}
+
+//-------------------------------------------------------------------------------------------------
+void Log::stop() {
+    if (!running)
+        return;
+    std::cout.flush();
+    std::cerr.flush();
+    if (!running.exchange(false))
+        return;
+    wake.notify_one();
+    if (std::this_thread::get_id() == writer.get_id())
+        writer.detach();    // exit() called on the writer, it can not join itself
+    else
+        writer.join();
+    drain();
+    std::cout.rdbuf(coutBuf);
+    std::cerr.rdbuf(cerrBuf);
+}
+
+//-------------------------------------------------------------------------------------------------
+std::ostream& Log::out(Level level) {
+    init();
+    return *streams[level];
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Log::setLevel(const lstring& name) {
+    static const char* names[] = { "error", "warn", "info", "debug" };
+    for (int idx = 0; idx < LEVEL_CNT; idx++) {
+        if (strncasecmp(name, names[idx], name.length()) == 0 && !name.empty()) {
+            level = idx;
+            return true;
+        }
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Multiple producer, single consumer intrusive queue (Vyukov), push is one atomic exchange.
+void Log::push(FILE* file, const char* text, size_t len) {
+    Node* node = new Node();
+    node->next = nullptr;
+    node->file = file;
+    node->text.assign(text, len);
+    Node* prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+    wake.notify_one();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Write all queued messages, only called by writer (or after it stopped).
+bool Log::drain() {
+    bool wrote = false;
+    FILE* lastFile = nullptr;
+    Node* next;
+    while ((next = tail->next.load(std::memory_order_acquire)) != nullptr) {
+        if (lastFile != nullptr && lastFile != next->file)
+            fflush(lastFile);
+        fwrite(next->text.data(), 1, next->text.size(), next->file);
+        lastFile = next->file;
+        delete tail;
+        tail = next;
+        wrote = true;
+    }
+    if (lastFile != nullptr)
+        fflush(lastFile);
+    return wrote;
+}
+
+//-------------------------------------------------------------------------------------------------
+void Log::run() {
+    while (running) {
+        if (!drain()) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(IDLE_MSEC));
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Per thread pending text of each level.
+static lstring& pending(int level) {
+    thread_local lstring buffers[Log::LEVEL_CNT];
+    return buffers[level];
+}
+
+void Log::Buf::append(const char* text, size_t len) {
+    if (level > Log::level)
+        return;
+    if (!running) {
+        fwrite(text, 1, len, file);
+        return;
+    }
+    lstring& buffer = pending(level);
+    buffer.append(text, len);
+    size_t lineEnd = buffer.rfind('\n');
+    if (lineEnd != lstring::npos) {
+        Log::push(file, buffer.data(), lineEnd + 1);
+        buffer.erase(0, lineEnd + 1);
+    }
+}
+
+std::streambuf::int_type Log::Buf::overflow(int_type ch) {
+    if (ch != traits_type::eof()) {
+        char chr = (char)ch;
+        append(&chr, 1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize Log::Buf::xsputn(const char* text, std::streamsize len) {
+    append(text, (size_t)len);
+    return len;
+}
+
+// Flush (std::endl, std::flush) pushes partial line, ex: progress line ending with \r
+int Log::Buf::sync() {
+    if (!running)
+        return fflush(file);
+    lstring& buffer = pending(level);
+    if (!buffer.empty()) {
+        Log::push(file, buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    return 0;
+}
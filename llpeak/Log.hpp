@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------------------------------------
+// File: Log.hpp
+// Desc: Asynchronous leveled log sink for std::cout / std::cerr
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "ll_stdhdr.hpp"
+
+// C++
+#include <atomic>
+#include <iostream>
+#include <streambuf>
+
+
+//-------------------------------------------------------------------------------------------------
+// Asynchronous log, std::cout (info) and std::cerr (error) are redirected to it by start().
+// Each thread collects text in its own buffer, complete lines are pushed on a lock free
+// multiple producer queue and written by one background thread, so workers never wait
+// on console stream locks. Messages above the current level are dropped.
+class Log {
+public:
+    enum Level { ERROR, WARN, INFO, DEBUG, LEVEL_CNT };
+    
+    static std::atomic<int> level;      // -log=<level>, default INFO
+    
+    static void start();
+    static void stop();     // Drain queue, restore std::cout and std::cerr
+    
+    // Stream of a level, ex: Log::out(Log::DEBUG) << "detail" << std::endl;
+    static std::ostream& out(Level level);
+    static bool setLevel(const lstring& name);
+    
+private:
+    // Stream buffer without put area, every write lands in the calling thread's buffer.
+    class Buf : public std::streambuf {
+    public:
+        Buf(Level _level, FILE* _file) : level(_level), file(_file) { }
+        
+    protected:
+        int_type overflow(int_type ch);
+        std::streamsize xsputn(const char* text, std::streamsize len);
+        int sync();
+        
+    private:
+        Level level;
+        FILE* file;
+        void append(const char* text, size_t len);
+    };
+    
+    struct Node {
+        std::atomic<Node*> next;
+        FILE* file;
+        lstring text;
+    };
+    
+    static Buf* bufs[LEVEL_CNT];
+    static std::ostream* streams[LEVEL_CNT];
+    static std::atomic<Node*> head;
+    static Node* tail;
+    static std::streambuf* coutBuf;
+    static std::streambuf* cerrBuf;
+    
+    static void init();
+    static void push(FILE* file, const char* text, size_t len);
+    static bool drain();
+    static void run();
+};
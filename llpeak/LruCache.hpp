@@ -0,0 +1,67 @@
+//
+//  Fixed capacity least recently used cache.
+//  Manage objects by value.
+//  Thread safe, Get and Put lock a mutex.
+//  Put of a new key evicts the least recently used entry when full.
+//
+
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+
+template <class K, class T>
+class LruCache
+{
+public:
+    LruCache(size_t capacity = 32)
+        : m_capacity(capacity > 0 ? capacity : 1)
+        { }
+
+    // Copy cached value and mark most recently used, return false if missing.
+    bool Get(const K& key, T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+        m_items.splice(m_items.begin(), m_items, it->second);
+        value = it->second->second;
+        return true;
+    }
+
+    void Put(const K& key, const T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            it->second->second = value;
+            m_items.splice(m_items.begin(), m_items, it->second);
+            return;
+        }
+        if (m_items.size() >= m_capacity) {
+            m_index.erase(m_items.back().first);
+            m_items.pop_back();
+        }
+        m_items.push_front(std::make_pair(key, value));
+        m_index[key] = m_items.begin();
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_index.clear();
+        m_items.clear();
+    }
+
+private:
+    typedef std::list<std::pair<K, T>> Items;
+    Items                   m_items;        // Most recently used first
+    std::unordered_map<K, typename Items::iterator> m_index;
+    size_t                  m_capacity;
+    std::mutex              m_mutex;
+};
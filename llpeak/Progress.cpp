@@ -0,0 +1,164 @@
+//-------------------------------------------------------------------------------------------------
+// File: Progress.cpp
+// Desc: Rate limited progress line with ETA and periodic status file
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "Progress.hpp"
+#include "FileUtil.hpp"
+#include "RunStats.hpp"
+
+// C++
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef HAVE_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+
+bool Progress::enabled = false;
+lstring Progress::statusPath;
+std::atomic<size_t> Progress::framesDone(0);
+std::atomic<size_t> Progress::bytesIn(0);
+std::atomic<size_t> Progress::bytesOut(0);
+std::atomic<int>    Progress::saveQueued(0);
+std::atomic<size_t> Progress::total(0);
+std::thread Progress::reporter;
+std::mutex Progress::mutex;
+std::condition_variable Progress::wake;
+bool Progress::running = false;
+
+static const unsigned TTY_MSEC = 250;       // Interactive redraw rate limit
+static const unsigned LOG_MSEC = 5000;      // Non-interactive line period
+static const unsigned STATUS_MSEC = 1000;   // Status file period
+
+//-------------------------------------------------------------------------------------------------
+bool Progress::isTty() {
+#ifdef HAVE_WIN
+    return _isatty(_fileno(stderr)) != 0;
+#else
+    return isatty(STDERR_FILENO) != 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+void Progress::start(size_t totalFrames) {
+    total = totalFrames;
+    if (!enabled && statusPath.empty())
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        reporter = std::thread(&Progress::run);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Final report and join reporter thread.
+void Progress::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        running = false;
+        wake.notify_all();
+    }
+    reporter.join();
+}
+
+//-------------------------------------------------------------------------------------------------
+void Progress::run() {
+    const bool tty = isTty();
+    const unsigned lineMsec = tty ? TTY_MSEC : LOG_MSEC;
+    const unsigned tickMsec = statusPath.empty() ? lineMsec : std::min(lineMsec, STATUS_MSEC);
+    const double startSec = RunStats::now();
+    double lineSec = 0;
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        wake.wait_for(lock, std::chrono::milliseconds(tickMsec));
+        double elapsed = RunStats::now() - startSec;
+        bool done = !running;
+        bool showLine = enabled && (done || elapsed - lineSec >= lineMsec / 1000.0);
+        if (showLine)
+            lineSec = elapsed;
+        if (showLine || !statusPath.empty())
+            report(elapsed, done, showLine, tty);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Progress line (when enabled) and status file (when set).
+void Progress::report(double elapsed, bool done, bool showLine, bool tty) {
+    const double MB = 1024.0 * 1024.0;
+    size_t frames = framesDone;
+    size_t frameTotal = total;
+    double fps = (elapsed > 0) ? frames / elapsed : 0;
+    double mbIn = (elapsed > 0) ? bytesIn / MB / elapsed : 0;
+    double mbOut = (elapsed > 0) ? bytesOut / MB / elapsed : 0;
+    int queued = saveQueued;
+    long etaSec = (fps > 0 && frameTotal > frames) ? (long)((frameTotal - frames) / fps + 0.5) : 0;
+    
+    if (showLine) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1)
+            << " " << frames << "/" << frameTotal << " frames  "
+            << fps << " fps  in " << mbIn << " MB/s  out " << mbOut << " MB/s  queue " << queued
+            << "  ETA " << etaSec / 60 << ":" << std::setw(2) << std::setfill('0') << etaSec % 60;
+        if (tty) {
+            std::cerr << "\r" << line.str() << "   " << (done ? "\n" : "") << std::flush;
+        } else {
+            std::cerr << line.str() << std::endl;
+        }
+    }
+    
+    if (!statusPath.empty()) {
+        lstring tmpPath = statusPath + ".tmp";
+        std::ofstream out(tmpPath);
+        out << std::fixed << std::setprecision(3)
+            << "{ \"state\": \"" << (done ? "done" : "running") << "\""
+            << ", \"done\": " << frames << ", \"total\": " << frameTotal
+            << ", \"elapsed\": " << elapsed << ", \"fps\": " << fps
+            << ", \"inMBps\": " << mbIn << ", \"outMBps\": " << mbOut
+            << ", \"saveQueue\": " << queued << ", \"etaSec\": " << etaSec << " }\n";
+        out.close();
+        if (!out || !FileUtil::replaceFile(tmpPath, statusPath)) {
+            std::cerr << strerror(errno) << ", Failed to write status " << statusPath << std::endl;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+//-------------------------------------------------------------------------------------------------
+// File: Progress.hpp
+// Desc: Rate limited progress line with ETA and periodic status file
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "ll_stdhdr.hpp"
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+//-------------------------------------------------------------------------------------------------
+// Background reporter of frames done/total, frames/sec, MB/s in and out, save queue depth and ETA.
+// Interactive (stderr tty) redraws one line at most 4 times a second, else prints a line
+// every few seconds. -status=<file> periodically rewrites a JSON status file for polling.
+class Progress {
+public:
+    static bool enabled;        // -progress
+    static lstring statusPath;  // -status=<file.json>
+    
+    // Counters updated by workers.
+    static std::atomic<size_t> framesDone;
+    static std::atomic<size_t> bytesIn;
+    static std::atomic<size_t> bytesOut;
+    static std::atomic<int>    saveQueued;
+    
+    static void frameDone() {
+        framesDone++;
+    }
+    
+    static void start(size_t totalFrames);
+    static void setTotal(size_t totalFrames) {  // Commands without input files
+        total = totalFrames;
+    }
+    static void stop();
+    static bool isTty();
+    
+private:
+    static std::atomic<size_t> total;
+    static std::thread reporter;
+    static std::mutex mutex;
+    static std::condition_variable wake;
+    static bool running;
+    
+    static void run();
+    static void report(double elapsed, bool done, bool showLine, bool tty);
+};
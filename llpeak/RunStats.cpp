@@ -0,0 +1,251 @@
+//-------------------------------------------------------------------------------------------------
+// File: RunStats.cpp
+// Desc: Per-stage timing and throughput statistics (-stats)
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Project files
+#include "RunStats.hpp"
+#include "Progress.hpp"
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+#ifdef HAVE_WIN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+
+bool RunStats::enabled = false;
+bool RunStats::tracing = false;
+RunStats::Samples RunStats::stages[RunStats::STAGE_CNT];
+std::vector<RunStats::TraceEvent> RunStats::events;
+std::mutex RunStats::mutex;
+const RunStats::Clock::time_point RunStats::startTime = RunStats::Clock::now();
+
+//-------------------------------------------------------------------------------------------------
+void RunStats::add(Stage stage, Clock::time_point begin, Clock::time_point end, size_t bytes, const lstring& frame) {
+    typedef std::chrono::duration<double> Seconds;
+    typedef std::chrono::duration<double, std::micro> Micros;
+    unsigned tid = tracing ? threadId() : 0;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (enabled) {
+        stages[stage].seconds.push_back(Seconds(end - begin).count());
+        stages[stage].bytes += bytes;
+    }
+    if (tracing) {
+        TraceEvent event = { stage, tid, Micros(begin - startTime).count(), Micros(end - begin).count(), frame };
+        events.push_back(event);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t RunStats::peakRss() {
+#ifdef HAVE_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;             // bytes
+#else
+    return (size_t)usage.ru_maxrss * 1024;      // kilobytes
+#endif
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+void RunStats::enableTrace() {
+    threadId();
+    tracing = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Small sequential id per thread, first caller (main) is 0.
+unsigned RunStats::threadId() {
+    static std::atomic<unsigned> nextId(0);
+    thread_local unsigned id = nextId++;
+    return id;
+}
+
+//-------------------------------------------------------------------------------------------------
+static lstring& frameSlot() {
+    thread_local lstring frame;
+    return frame;
+}
+void RunStats::setFrame(const lstring& frame) {
+    frameSlot() = frame;
+}
+const lstring& RunStats::getFrame() {
+    return frameSlot();
+}
+
+//-------------------------------------------------------------------------------------------------
+const char* RunStats::name(Stage stage) {
+    static const char* names[] = { "load", "convert", "map", "kernel", "encode", "write", "save-wait", "mem-wait" };
+    return (stage < STAGE_CNT) ? names[stage] : "?";
+}
+
+//-------------------------------------------------------------------------------------------------
+double RunStats::now() {
+    std::chrono::duration<double> span = Clock::now() - startTime;
+    return span.count();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Nearest rank percentile of sorted samples.
+double RunStats::percentile(std::vector<double>& sorted, double pct) {
+    if (sorted.empty())
+        return 0;
+    size_t rank = (size_t)std::ceil(pct / 100 * sorted.size());
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+//-------------------------------------------------------------------------------------------------
+// Total sums all threads, can exceed elapsed wall time.
+void RunStats::print(std::ostream& out, double elapsed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const double MB = 1024.0 * 1024.0;
+    
+    out << "\nStage       Count   Total(s)    p50(ms)    p99(ms)      MB/s\n";
+    for (unsigned idx = 0; idx < STAGE_CNT; idx++) {
+        Samples& samples = stages[idx];
+        std::vector<double> sorted(samples.seconds);
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0;
+        for (double seconds : sorted)
+            total += seconds;
+        
+        out << std::left << std::setw(8) << name((Stage)idx) << std::right
+            << std::setw(9) << sorted.size()
+            << std::fixed << std::setprecision(3)
+            << std::setw(11) << total
+            << std::setw(11) << percentile(sorted, 50) * 1000
+            << std::setw(11) << percentile(sorted, 99) * 1000;
+        if (samples.bytes != 0 && total > 0)
+            out << std::setw(10) << std::setprecision(1) << samples.bytes / MB / total;
+        else
+            out << std::setw(10) << "-";
+        out << std::endl;
+    }
+    size_t frames = Progress::framesDone;
+    out << "Frames " << frames << std::fixed << std::setprecision(1)
+        << ", " << ((elapsed > 0) ? frames / elapsed : 0) << " frames/sec"
+        << ", peak RSS " << peakRss() / MB << " MB\n";
+    out << "Elapsed " << std::fixed << std::setprecision(3) << elapsed << " (sec)\n";
+    out.unsetf(std::ios::floatfield);
+}
+
+//-------------------------------------------------------------------------------------------------
+bool RunStats::saveJson(const lstring& path, double elapsed) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << strerror(errno) << ", Failed to write stats " << path << std::endl;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    out << std::fixed << std::setprecision(6);
+    size_t frames = Progress::framesDone;
+    out << "{\n  \"elapsed\": " << elapsed
+        << ",\n  \"frames\": " << frames
+        << ",\n  \"fps\": " << ((elapsed > 0) ? frames / elapsed : 0)
+        << ",\n  \"peakRssMB\": " << peakRss() / (1024.0 * 1024.0)
+        << ",\n  \"stages\": {\n";
+    for (unsigned idx = 0; idx < STAGE_CNT; idx++) {
+        Samples& samples = stages[idx];
+        std::vector<double> sorted(samples.seconds);
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0;
+        for (double seconds : sorted)
+            total += seconds;
+        
+        out << "    \"" << name((Stage)idx) << "\": {"
+            << " \"count\": " << sorted.size()
+            << ", \"total\": " << total
+            << ", \"p50\": " << percentile(sorted, 50)
+            << ", \"p99\": " << percentile(sorted, 99)
+            << ", \"bytes\": " << samples.bytes
+            << ", \"MBps\": " << ((total > 0) ? samples.bytes / (1024.0 * 1024.0) / total : 0)
+            << " }" << ((idx + 1 < STAGE_CNT) ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    return out.good();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Write Chrome/Perfetto trace events, view with chrome://tracing or ui.perfetto.dev
+// Each stage is a complete event (begin + duration) on its thread, args hold the frame.
+bool RunStats::saveTrace(const lstring& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << strerror(errno) << ", Failed to write trace " << path << std::endl;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned maxTid = 0;
+    for (const TraceEvent& event : events)
+        maxTid = std::max(maxTid, event.tid);
+    
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (unsigned tid = 0; tid <= maxTid; tid++) {
+        out << "{\"ph\": \"M\", \"pid\": 1, \"tid\": " << tid
+            << ", \"name\": \"thread_name\", \"args\": {\"name\": \""
+            << ((tid == 0) ? "main" : "thread " + std::to_string(tid)) << "\"}},\n";
+    }
+    for (size_t idx = 0; idx < events.size(); idx++) {
+        const TraceEvent& event = events[idx];
+        lstring frame(event.frame);
+        for (size_t pos = 0; (pos = frame.find_first_of("\"\\", pos)) != lstring::npos; pos += 2)
+            frame.insert(pos, 1, '\\');
+        out << "{\"ph\": \"X\", \"pid\": 1, \"tid\": " << event.tid
+            << ", \"name\": \"" << name(event.stage) << "\", \"cat\": \"stage\""
+            << ", \"ts\": " << event.beginUs << ", \"dur\": " << event.durUs
+            << ", \"args\": {\"frame\": \"" << frame << "\"}}"
+            << ((idx + 1 < events.size()) ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    return out.good();
+}
@@ -0,0 +1,127 @@
+//-------------------------------------------------------------------------------------------------
+// File: RunStats.hpp
+// Desc: Per-stage timing and throughput statistics (-stats)
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "ll_stdhdr.hpp"
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// Collect per-stage latency samples and byte counts, thread safe.
+// Optionally record Chrome trace events (-trace) per stage, frame and thread.
+// Disabled by default, timers cost a flag test until -stats or -trace enables them.
+class RunStats {
+public:
+    enum Stage { LOAD, CONVERT, MAP, KERNEL, ENCODE, WRITE, SAVE_WAIT, MEM_WAIT, STAGE_CNT };
+    typedef std::chrono::steady_clock Clock;
+    
+    static bool enabled;    // -stats
+    static bool tracing;    // -trace
+    
+    // Start recording trace events, calling thread is labeled main.
+    static void enableTrace();
+    static void add(Stage stage, Clock::time_point begin, Clock::time_point end, size_t bytes, const lstring& frame);
+    static const char* name(Stage stage);
+    
+    // Monotonic seconds since program start.
+    static double now();
+    // Peak resident memory of process in bytes, 0 if unknown.
+    static size_t peakRss();
+    
+    // Frame (input file) currently processed by calling thread, labels trace events.
+    static void setFrame(const lstring& frame);
+    static const lstring& getFrame();
+    
+    static void print(std::ostream& out, double elapsed);
+    static bool saveJson(const lstring& path, double elapsed);
+    static bool saveTrace(const lstring& path);
+    
+private:
+    struct Samples {
+        std::vector<double> seconds;
+        size_t bytes = 0;
+    };
+    struct TraceEvent {
+        Stage stage;
+        unsigned tid;
+        double beginUs;
+        double durUs;
+        lstring frame;
+    };
+    static Samples stages[STAGE_CNT];
+    static std::vector<TraceEvent> events;
+    static std::mutex mutex;
+    static const Clock::time_point startTime;
+    
+    static unsigned threadId();
+    static double percentile(std::vector<double>& sorted, double pct);
+};
+
+//-------------------------------------------------------------------------------------------------
+// Scoped timer, adds its lifetime to a stage.
+class StageTimer {
+public:
+    StageTimer(RunStats::Stage _stage, size_t _bytes = 0, const char* _frame = nullptr) :
+        stage(_stage), bytes(_bytes), active(RunStats::enabled || RunStats::tracing) {
+        if (active) {
+            if (RunStats::tracing)
+                frame = (_frame != nullptr) ? lstring(_frame) : RunStats::getFrame();
+            start = RunStats::Clock::now();
+        }
+    }
+    ~StageTimer() {
+        stop();
+    }
+    
+    void setBytes(size_t _bytes) {
+        bytes = _bytes;
+    }
+    void stop() {
+        if (active) {
+            active = false;
+            RunStats::add(stage, start, RunStats::Clock::now(), bytes, frame);
+        }
+    }
+    
+private:
+    RunStats::Stage stage;
+    size_t bytes;
+    bool active;
+    lstring frame;
+    RunStats::Clock::time_point start;
+};
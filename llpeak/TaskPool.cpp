@@ -0,0 +1,204 @@
+//-------------------------------------------------------------------------------------------------
+// File: TaskPool.cpp
+// Desc: Work stealing scheduler shared by all commands, TaskPool task groups run on it.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Project files
+#include "TaskPool.hpp"
+
+// C++
+#include <chrono>
+
+
+static thread_local int workerIdx = -1;     // Scheduler worker of calling thread, -1 = outside
+static unsigned workerLimit = 0;            // Scheduler::limit, 0 = all cores
+
+//-------------------------------------------------------------------------------------------------
+// Requested thread count, 0 = all cores (or Scheduler::limit).
+unsigned TaskPool::coreCount(unsigned threadCnt) {
+    if (threadCnt != 0)
+        return threadCnt;
+    return (workerLimit != 0) ? workerLimit : std::max(1u, std::thread::hardware_concurrency());
+}
+
+//-------------------------------------------------------------------------------------------------
+void Scheduler::limit(unsigned workerCnt) {
+    workerLimit = workerCnt;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Workers live until process exit, never joined, so exit() from a signal does not wait on tasks.
+Scheduler& Scheduler::get() {
+    static Scheduler* scheduler = new Scheduler(TaskPool::coreCount());
+    return *scheduler;
+}
+
+//-------------------------------------------------------------------------------------------------
+Scheduler::Scheduler(unsigned workerCnt) : queued(0) {
+    for (unsigned idx = 0; idx <= workerCnt; idx++) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (unsigned idx = 0; idx < workerCnt; idx++) {
+        workers.push_back(std::thread(&Scheduler::worker, this, idx));
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void Scheduler::submit(const Task& task) {
+    Queue& queue = *queues[(workerIdx >= 0) ? workerIdx : workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    wake.notify_one();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Own deque newest first, then oldest of inject and other deques.
+bool Scheduler::take(unsigned idx, Task& task) {
+    if (queued == 0)
+        return false;
+    
+    unsigned queueCnt = (unsigned)queues.size();
+    for (unsigned offset = 0; offset < queueCnt; offset++) {
+        Queue& queue = *queues[(idx + offset) % queueCnt];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            if (offset == 0 && idx < workers.size()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Scheduler::runOne() {
+    Task task;
+    if (take((workerIdx >= 0) ? workerIdx : (unsigned)workers.size(), task)) {
+        task();
+        return true;
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+void Scheduler::worker(unsigned idx) {
+    workerIdx = (int)idx;
+    for (;;) {
+        Task task;
+        if (take(idx, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return queued != 0; });
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+TaskPool::TaskPool(unsigned threadCnt) : limit(coreCount(threadCnt)) {
+}
+
+//-------------------------------------------------------------------------------------------------
+TaskPool::~TaskPool() {
+    wait();
+}
+
+//-------------------------------------------------------------------------------------------------
+void TaskPool::add(const Task& task) {
+    if (limit <= 1) {
+        task();
+        return;
+    }
+    bool startRunner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(task);
+        pending++;
+        if (runners < limit) {
+            runners++;
+            startRunner = true;
+        }
+    }
+    if (startRunner) {
+        Scheduler::get().submit([this]() { runner(); });
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Waiting thread takes a free runner slot, else helps run other queued Scheduler tasks
+// (which include this pool's runners not yet started).
+void TaskPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!idle()) {
+        if (!tasks.empty() && runners < limit) {
+            runners++;
+            lock.unlock();
+            runner();
+            lock.lock();
+            continue;
+        }
+        lock.unlock();
+        bool ran = Scheduler::get().runOne();
+        lock.lock();
+        if (!ran) {
+            allDone.wait_for(lock, std::chrono::milliseconds(1), [this]() { return idle(); });
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Run this pool's tasks until none are queued.
+void TaskPool::runner() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!tasks.empty()) {
+        Task task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+        pending--;
+    }
+    runners--;
+    if (idle()) {
+        allDone.notify_all();
+    }
+}
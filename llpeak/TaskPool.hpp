@@ -0,0 +1,114 @@
+//-------------------------------------------------------------------------------------------------
+// File: TaskPool.hpp
+// Desc: Work stealing scheduler shared by all commands, TaskPool task groups run on it.
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2022
+// https://landenlabs.com
+//
+// This file is part of llpeak project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//-------------------------------------------------------------------------------------------------
+// One process wide set of workers, sized to the cores or -threads, each with its own task deque.
+// A worker pushes and pops its own deque at the back (newest first, cache warm), idle
+// workers steal from the front of other deques. Threads outside the scheduler submit
+// to a shared inject deque. Blocked waiters run queued tasks (runOne) so nested
+// parallel work (jobs > frames > bands) never needs more threads than cores.
+class Scheduler {
+public:
+    typedef std::function<void()> Task;
+    
+    static Scheduler& get();            // Started on first use
+    static void limit(unsigned workerCnt);  // -threads, before first use, 0 = all cores
+    
+    void submit(const Task& task);
+    bool runOne();                      // Run one queued task on calling thread, false if none
+    unsigned size() const {
+        return (unsigned)workers.size();
+    }
+    
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    
+    Scheduler(unsigned workerCnt);
+    
+    bool take(unsigned idx, Task& task);
+    void worker(unsigned idx);
+    
+    std::vector<std::unique_ptr<Queue>> queues;     // Per worker, last is inject queue
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> queued;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
+
+//-------------------------------------------------------------------------------------------------
+// Group of tasks on the Scheduler with at most threadCnt running at once.
+// threadCnt 1 runs each task inline in add(), in order.
+class TaskPool {
+public:
+    typedef Scheduler::Task Task;
+    
+    TaskPool(unsigned threadCnt = 0);   // 0 = all cores
+    ~TaskPool();
+    
+    void add(const Task& task);
+    void wait();                        // Wait for all added tasks, runs queued tasks meanwhile.
+    
+    unsigned size() const {
+        return limit;
+    }
+    
+    static unsigned coreCount(unsigned threadCnt = 0);
+    
+private:
+    void runner();
+    bool idle() const {
+        return pending == 0 && runners == 0;
+    }
+    
+    std::deque<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable allDone;
+    unsigned limit;
+    unsigned runners = 0;               // Runner tasks started on the Scheduler
+    unsigned pending = 0;               // Tasks added, not finished
+};
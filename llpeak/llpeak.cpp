@@ -46,9 +46,19 @@
 #include "CmdDumpF.hpp"
 #include "CmdBlurF.hpp"
 #include "CmdToGrayF.hpp"
+#include "CmdMultiF.hpp"
+#include "CmdPipelineF.hpp"
+#include "CmdMontageF.hpp"
+#include "CmdGenerateF.hpp"
 #include "Directory.hpp"
 #include "Split.hpp"
 #include "ImageCfg.hpp"
+#include "RunStats.hpp"
+#include "FMemory.hpp"
+#include "Progress.hpp"
+#include "FrameHash.hpp"
+#include "Log.hpp"
+#include "TaskPool.hpp"
 
 // C++
 #include <algorithm>
@@ -56,8 +66,10 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <regex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 // C
@@ -75,6 +87,7 @@ typedef unsigned int uint;
 
 uint optionErrCnt = 0;
 uint patternErrCnt = 0;
+bool watchMode = false;     // First interrupt stops watching instead of exiting
 
 #ifdef HAVE_WIN
 #include <assert.h>
@@ -89,8 +102,10 @@ uint patternErrCnt = 0;
 
 //-------------------------------------------------------------------------------------------------
 // Recurse over directories, locate files.
-static size_t InspectFiles(Command& command, const lstring& dirname, unsigned depth) {
-    static std::vector<size_t> counts(10, 0);
+// Counts holds files found per directory depth for the scan status line.
+static size_t InspectFiles(Command& command, const lstring& dirname, unsigned depth, std::vector<size_t>& counts) {
+    if (counts.size() < depth + 2)
+        counts.resize(depth + 2, 0);
 
     if (Command::abortFlag) {
         return 0;
@@ -116,13 +131,13 @@ static size_t InspectFiles(Command& command, const lstring& dirname, unsigned de
         if (directory.is_directory()) {
             counts[depth + 1] = 0;
             fileCount += command.add(fullname, IS_DIR_BEG);  // add directory, fullname may change
-            fileCount += InspectFiles(command, fullname, depth + 1);
+            fileCount += InspectFiles(command, fullname, depth + 1, counts);
             fileCount += command.add(fullname, IS_DIR_END);  // add directory.
         } else if (fullname.length() > 0) {
             fileCount += command.add(fullname, IS_FILE);
         }
 
-        if (fileCount >= counts[depth] + 10) {
+        if (fileCount >= counts[depth] + 10 && Progress::isTty()) {
             counts[depth] = fileCount;
             std::cerr << "\r ";
             for (unsigned idx = 0; idx <= depth; idx++)
@@ -252,27 +267,58 @@ void showHelp(char* name) {
             " Options (only first unique characters required, options can be repeated): \n"
             "\n"
             "   -blend   ; Sequenced image blend\n"
-            "   -dump    ; Dump image info, palette, create palette legends \n"
+            "   -dump    ; Dump image info, palette, create <name>-palette*.png legends in -output \n"
             "   -shade1  ; Apply shade (2+D) look to image (equation #1)\n"
             "   -shade2  ; Apply shade (2+D) look to image (equation #2) \n"
             "   -blur    ; Blur (smooth) image \n"
             "   -colorlapse ; Timelapse color blend \n"
-            "   -montage ; Merge image tiles together \n"
+            "   -pipeline=<cmd>,<cmd>... ; Run commands as in-memory stages, ex: blur,shade2 \n"
+            "                 Stages: blur, shade1, shade2, shade3, togray, blend, colorlapse \n"
+            "   -montage=<cols>x<rows> ; Merge image tiles together, rows optional \n"
             "   -toGray  ; Convert 32bit gray to 8bit gray \n"
+            "   -generate=<W>x<H>,<frames>[,<coverage>[,<bits>]] ; Synthetic radar sequence \n"
+            "                 Moving storm cells in -config palette, coverage 0..1, bits 8 or 32 \n"
             "\n"
             "   -config[=]<config.json>   ; Image palette and manipulation configuration \n"
+            "                               Repeat -config=<cfg> -<command> -output=<dir> to run\n"
+            "                               several jobs on one pass of decoded frames \n"
+            "   -checkpoint=<state.json>  ; Blend saves overlay/bottom state and last frame \n"
+            "   -resume                   ; Blend continues from -checkpoint state \n"
+            "   -watch                    ; Blend/Shade keep running, process new files as they arrive \n"
+            "   -parallel                 ; Blend splits frames into chunks run on all cores \n"
+            "   -indexed                  ; Blend/Colorlapse save 8bit palette images \n"
+            "   -threads=<count>          ; Limit worker threads, includes image saves \n"
+            "   -pyramid=<tileSize>       ; Blend/Montage also save z/x/y tile pyramid, ex 256 \n"
+            "                               out/frame.png => out/frame/<z>/<x>/<y>.png \n"
+            "   -stats[=<stats.json>]     ; Show per-stage time, p50/p99 latency and MB/s \n"
+            "                               (load, convert, map, kernel, encode, write, save-wait) \n"
+            "                               frames/sec and peak RSS \n"
+            "   -trace=<trace.json>       ; Save Chrome/Perfetto trace events per stage, frame, thread \n"
+            "   -progress                 ; Show frames done/total, fps, MB/s in/out, save queue and ETA \n"
+            "   -status=<status.json>     ; Periodically rewrite machine readable progress status \n"
+            "   -hashes=<hashes.txt>      ; Save pixel hash of every output frame, diff against golden \n"
+            "   -max-memory=<MB>          ; Image memory budget, loads and saves stall while over \n"
+            "                               Report live image memory with: kill -USR1 <pid> \n"
             "\n"
             " Generic commands: (all directories recursively scanned) \n"
             "   -includefile=<filePattern>\n"
             "   -excludefile=<filePattern>\n"
             "   -config <filecfg.json>\n"
-            "   -verbose \n"
+            "   -verbose                  ; Also sets -log=debug \n"
+            "   -log=<level>              ; Console output level: error, warn, info (default), debug \n"
+            "                               debug adds per frame 'Thread - saved' messages \n"
             "\n"
             " Example: \n"
             "   llpeak -include=\\*.png -exclude=Wind\\*png -config radar.json ~/data/ \n"
             "   llpeak -config shade.json ~/datapath1/ ~/datapath2/ foo.png car.jpg \n"
             "   llpeak -dump foo.png \n"
-            "   llpeak -montage=4x3 -include=\\*.png -output=bigImage.png ~/tiles"
+            "   llpeak -config=radar.json -blend -out=radar/ -config=temp.json -blend -out=temp/ ~/data \n"
+            "   llpeak -config=radar.json -pipeline=blur,shade2 -out=shaded/ ~/data \n"
+            "   llpeak -blend -config radar.json -checkpoint=state.json -resume ~/radar \n"
+            "   llpeak -montage=4x3 -include=\\*.png -output=bigImage.png ~/tiles \n"
+            "   llpeak -montage=4x3 -pyramid=256 -output=bigImage.png ~/tiles \n"
+            "   llpeak -config=radar.json -blend -stats=stats.json -out=radar/ ~/radar \n"
+            "   llpeak -config=radar.json -generate=1024x720,200,0.3 -out=synth/ \n"
             "\n"
             "\n";
 }
@@ -282,8 +328,14 @@ void showHelp(char* name) {
 BOOL WINAPI CtrlHandler(DWORD fdwCtrlType) {
     switch (fdwCtrlType) {
         case CTRL_C_EVENT:  // Handle the CTRL-C signal.
+            if (watchMode && !Command::abortFlag) {
+                Command::abortFlag = true;
+                std::cerr << "\nCaught signal - stop watching" << std::endl;
+                return TRUE;
+            }
             Command::abortFlag = true;
             std::cerr << "\nCaught signal " << std::endl;
+            FMemory::print(std::cerr);
             Beep(750, 300);
             exit(-1);
             return TRUE;
@@ -294,10 +346,28 @@ BOOL WINAPI CtrlHandler(DWORD fdwCtrlType) {
 
 #else
 //-------------------------------------------------------------------------------------------------
-void sigHandler(int /* sig_t */ s) {
-    Command::abortFlag = true;
-    std::cerr << "\nCaught signal - exiting" << std::endl;
-    exit(-1);
+// SIGINT and SIGUSR1 are blocked in every thread and taken here with sigwait, so they are
+// handled as ordinary code (log streams, locks, exit) instead of in an async signal handler.
+// SIGUSR1 - report image memory and keep running.
+void signalThread(sigset_t sigSet) {
+    for (;;) {
+        int sig = 0;
+        if (sigwait(&sigSet, &sig) != 0)
+            continue;
+        if (sig == SIGUSR1) {
+            FMemory::print(std::cerr);
+            continue;
+        }
+        if (watchMode && !Command::abortFlag) {
+            Command::abortFlag = true;
+            std::cerr << "\nCaught signal - stop watching" << std::endl;
+            continue;
+        }
+        Command::abortFlag = true;
+        std::cerr << "\nCaught signal - exiting" << std::endl;
+        FMemory::print(std::cerr);
+        exit(-1);
+    }
 }
 #endif
 
@@ -314,18 +384,78 @@ const std::string currentDateTime(time_t& now) {
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Config and commands for one job, several -config entries create several jobs.
+class JobCommands {
+public:
+    ImageCfg        imageCfg;
+    CmdBlendF       doBlendF;
+    CmdDumpF        doDumpF;
+    CmdShadeF       doShadeF;
+    CmdColorlapseF  doColorlapse;
+    CmdToGrayF      toGray;
+    CmdBlurF        doBlurF;
+    CmdPipelineF    doPipelineF;
+    CmdMontageF     doMontageF;
+    CmdGenerateF    doGenerateF;
+    CmdNone         doNone;
+    bool            hasConfig = false;
+    
+    JobCommands() :
+        doBlendF(&imageCfg), doDumpF(&imageCfg), doShadeF(&imageCfg), doColorlapse(&imageCfg),
+        toGray(&imageCfg), doBlurF(&imageCfg), doPipelineF(&imageCfg), doMontageF(&imageCfg),
+        doGenerateF(&imageCfg), doNone(&imageCfg)
+    { }
+    
+    // Select pipeline stage command by name, return nullptr if unknown.
+    Command* getStage(const lstring& stageName) {
+        if (stageName == "blend") {
+            return &doBlendF;
+        } else if (stageName == "blur") {
+            return &doBlurF;
+        } else if (stageName == "colorlapse") {
+            return &doColorlapse;
+        } else if (stageName == "togray") {
+            return &toGray;
+        } else if (stageName == "shade1") {
+            doShadeF.getAux().shadeRef = new FShadeXY1();
+            return &doShadeF;
+        } else if (stageName == "shade2") {
+            doShadeF.getAux().shadeRef = new FShadeXY2();
+            return &doShadeF;
+        } else if (stageName == "shade3") {
+            doShadeF.getAux().shadeRef = new FShadeXY3();
+            return &doShadeF;
+        }
+        return nullptr;
+    }
+};
+
 //-------------------------------------------------------------------------------------------------
 int main(int argc, char* argv[]) {
     StringList      fileDirList;
-    ImageCfg        imageCfg;
-    CmdBlendF       doBlendF(&imageCfg);
-    CmdDumpF        doDumpF(&imageCfg);
-    CmdShadeF       doShadeF(&imageCfg);
-    CmdColorlapseF  doColorlapse(&imageCfg);
-    CmdToGrayF      toGray(&imageCfg);
-    CmdBlurF        doBlurF(&imageCfg);
-    CmdNone         doNone(&imageCfg);
-    Command*        commandPtr = &doNone;
+    std::vector<std::unique_ptr<JobCommands>> jobList;
+    jobList.emplace_back(new JobCommands());
+    JobCommands*    job = jobList.back().get();
+    std::vector<Command*> jobCommands;
+    Command*        commandPtr = &job->doNone;
+    lstring         statsFile;      // -stats=<file.json>
+    lstring         traceFile;      // -trace=<file.json>
+    
+    // A -config after the current job has a config and command starts another job.
+    auto setConfig = [&](const lstring& cfgFile) {
+        if (job->hasConfig && commandPtr != &job->doNone) {
+            jobCommands.push_back(commandPtr);
+            jobList.emplace_back(new JobCommands());
+            job = jobList.back().get();
+            job->doNone.share(*commandPtr);
+            job->doNone.imageCfgRef = &job->imageCfg;
+            job->doNone.checkpoint.clear();
+            commandPtr = &job->doNone;
+        }
+        job->imageCfg.parseConfig(cfgFile);
+        job->hasConfig = true;
+    };
 
     
 #ifdef HAVE_WIN
@@ -333,17 +463,20 @@ int main(int argc, char* argv[]) {
         std::cerr << "Failed to install sig handler" << endl;
     }
 #else
-    // signal(SIGINT, sigHandler);
-
-    struct sigaction sigIntHandler;
-    sigIntHandler.sa_handler = sigHandler;
-    sigemptyset(&sigIntHandler.sa_mask);
-    sigIntHandler.sa_flags = 0;
-    if (sigaction(SIGINT, &sigIntHandler, NULL) != 0) {
+    // Block before any other thread starts, threads inherit the mask.
+    sigset_t sigSet;
+    sigemptyset(&sigSet);
+    sigaddset(&sigSet, SIGINT);
+    sigaddset(&sigSet, SIGUSR1);
+    if (pthread_sigmask(SIG_BLOCK, &sigSet, NULL) != 0) {
         std::cerr << "Failed to install sig handler" << endl;
+    } else {
+        std::thread(signalThread, sigSet).detach();
     }
 #endif
 
+    Log::start();       // Route std::cout / std::cerr through async log writer
+    
     if (argc == 1) {
         showHelp(argv[0]);
     } else {
@@ -361,9 +494,11 @@ int main(int argc, char* argv[]) {
 
                     switch (cmd[(unsigned)1]) {
                         case 'c':  // -config=<cfgFile.json>
-                            if (ValidOption("config", cmd + 1)) {
-                                imageCfg.parseConfig(value);
+                            if (ValidOption("config", cmd + 1, false)) {
+                                setConfig(value);
                                 // imageCfg().print();
+                            } else if (ValidOption("checkpoint", cmd + 1)) {
+                                commandPtr->checkpoint = value;
                             }
                             break;
                         case 'e':  // excludeFile=<pat>
@@ -372,6 +507,17 @@ int main(int argc, char* argv[]) {
                                 commandPtr->excludeFilePatList.push_back(getRegEx(value));
                             }
                             break;
+                        case 'g':  // generate=<width x height>,<frames>[,<coverage>[,<bits>]]
+                            if (ValidOption("generate", cmd + 1)) {
+                                commandPtr = &job->doGenerateF.share(*commandPtr);
+                                commandPtr->cmdValue = value;
+                            }
+                            break;
+                        case 'h':  // hashes=<file>
+                            if (ValidOption("hashes", cmd + 1)) {
+                                FrameHash::path = value;
+                            }
+                            break;
                         case 'i':
                             if (ValidOption("includefile", cmd + 1)) {
                                 // includeFile=<pat>
@@ -379,9 +525,18 @@ int main(int argc, char* argv[]) {
                                 commandPtr->includeFilePatList.push_back(getRegEx(value));
                             }
                             break;
-                        case 'm':  // montage=<width x height>
-                            if (ValidOption("montage", cmd + 1)) {
+                        case 'l':  // log=<error|warn|info|debug>
+                            if (ValidOption("log", cmd + 1) && !Log::setLevel(value)) {
+                                std::cerr << "Unknown log level " << value << ", use error, warn, info or debug\n";
+                                optionErrCnt++;
+                            }
+                            break;
+                        case 'm':  // montage=<width x height>  or max-memory=<MB>
+                            if (ValidOption("montage", cmd + 1, false)) {
+                                commandPtr = &job->doMontageF.share(*commandPtr);
                                 commandPtr->cmdValue = value;
+                            } else if (ValidOption("max-memory", cmd + 1)) {
+                                FMemory::maxBytes = (size_t)strtoul(value, nullptr, 10) << 20;
                             }
                             break;
                         case 'o':  // output=<path>
@@ -389,6 +544,44 @@ int main(int argc, char* argv[]) {
                                 commandPtr->output = value;
                             }
                             break;
+                        case 'p':  // pipeline=<cmd1>,<cmd2>,...  or pyramid=<tileSize>
+                            if (ValidOption("pyramid", cmd + 1, false)) {
+                                commandPtr->pyramid = (unsigned)strtoul(value, nullptr, 10);
+                            } else if (ValidOption("pipeline", cmd + 1)) {
+                                commandPtr = &job->doPipelineF.share(*commandPtr);
+                                Split stageNames(value.toLower(), ",");
+                                std::vector<Command*> stages;
+                                for (const lstring& stageName : stageNames) {
+                                    Command* stage = job->getStage(stageName);
+                                    if (stage == nullptr) {
+                                        std::cerr << "Unknown pipeline stage " << stageName << std::endl;
+                                        optionErrCnt++;
+                                    } else if (std::find(stages.begin(), stages.end(), stage) != stages.end()) {
+                                        std::cerr << "Pipeline stage used twice " << stageName << std::endl;
+                                        optionErrCnt++;
+                                    } else {
+                                        stages.push_back(stage);
+                                        job->doPipelineF.addStage(stage);
+                                    }
+                                }
+                            }
+                            break;
+                        case 's':  // stats=<file.json>  or status=<file.json>
+                            if (ValidOption("stats", cmd + 1, false)) {
+                                RunStats::enabled = true;
+                                statsFile = value;
+                            } else if (ValidOption("status", cmd + 1)) {
+                                Progress::statusPath = value;
+                            }
+                            break;
+                        case 't':  // threads=<count>  or trace=<file.json>
+                            if (ValidOption("trace", cmd + 1, false)) {
+                                RunStats::enableTrace();
+                                traceFile = value;
+                            } else if (ValidOption("threads", cmd + 1)) {
+                                commandPtr->threads = (unsigned)strtoul(value, nullptr, 10);
+                            }
+                            break;
 
                         default:
                             std::cerr << "Unknown parameters " << cmd << std::endl;
@@ -410,32 +603,33 @@ int main(int argc, char* argv[]) {
                         case 'v':
                             commandPtr->verbose = true;
                             commandPtr->showFile = true;
+                            Log::level = Log::DEBUG;
                             continue;
                             
                         case 'b':
                             if (ValidOption("blend", argStr + 1, false)) {
-                                commandPtr = &doBlendF.share(*commandPtr);
+                                commandPtr = &job->doBlendF.share(*commandPtr);
                                 continue;
                             } else if (ValidOption("blur", argStr + 1)) {
-                                commandPtr = &doBlurF.share(*commandPtr);
+                                commandPtr = &job->doBlurF.share(*commandPtr);
                                 continue;
                             }
                             break;
                             
                         case 'c':  // -config <cfgFile.json>
                             if (ValidOption("colorlapse", argStr + 1, false)) {
-                                commandPtr = &doColorlapse.share(*commandPtr);
+                                commandPtr = &job->doColorlapse.share(*commandPtr);
                                 continue;
                             } else if (ValidOption("config", argStr + 1) && argn < argc) {
                                 lstring value(argv[++argn]);
-                                imageCfg.parseConfig(value);
+                                setConfig(value);
                                 continue;
                             }
                             break;
                             
                         case 'd':
                             if (ValidOption("dump", argStr + 1)) {
-                                commandPtr = &doDumpF.share(*commandPtr);
+                                commandPtr = &job->doDumpF.share(*commandPtr);
                                 continue;
                             }
                             break;
@@ -449,23 +643,57 @@ int main(int argc, char* argv[]) {
                     
                         case 's':
                             if (ValidOption("shade1", argStr + 1, false)) {
-                                commandPtr = &doShadeF.share(*commandPtr);
-                                doShadeF.getAux().shadeRef = new FShadeXY1();
+                                commandPtr = &job->doShadeF.share(*commandPtr);
+                                job->doShadeF.getAux().shadeRef = new FShadeXY1();
                                 continue;
                             } else if (ValidOption("shade2", argStr + 1, false)) {
-                                commandPtr = &doShadeF.share(*commandPtr);
-                                doShadeF.getAux().shadeRef = new FShadeXY2();
+                                commandPtr = &job->doShadeF.share(*commandPtr);
+                                job->doShadeF.getAux().shadeRef = new FShadeXY2();
+                                continue;
+                            } else if (ValidOption("stats", argStr + 1, false)) {
+                                RunStats::enabled = true;
                                 continue;
                             } else if (ValidOption("shade3", argStr + 1)) {
-                                commandPtr = &doShadeF.share(*commandPtr);
-                                doShadeF.getAux().shadeRef = new FShadeXY3();
+                                commandPtr = &job->doShadeF.share(*commandPtr);
+                                job->doShadeF.getAux().shadeRef = new FShadeXY3();
+                                continue;
+                            }
+                            break;
+                            
+                        case 'i':
+                            if (ValidOption("indexed", argStr + 1)) {
+                                commandPtr->indexed = true;
+                                continue;
+                            }
+                            break;
+                            
+                        case 'p':
+                            if (ValidOption("parallel", argStr + 1, false)) {
+                                commandPtr->parallel = true;
+                                continue;
+                            } else if (ValidOption("progress", argStr + 1)) {
+                                Progress::enabled = true;
+                                continue;
+                            }
+                            break;
+                            
+                        case 'r':
+                            if (ValidOption("resume", argStr + 1)) {
+                                commandPtr->resume = true;
                                 continue;
                             }
                             break;
                             
                         case 't':
                             if (ValidOption("togray", argStr + 1)) {
-                                commandPtr = &toGray.share(*commandPtr);
+                                commandPtr = &job->toGray.share(*commandPtr);
+                                continue;
+                            }
+                            break;
+                            
+                        case 'w':
+                            if (ValidOption("watch", argStr + 1)) {
+                                commandPtr->watch = watchMode = true;
                                 continue;
                             }
                             break;
@@ -491,36 +719,81 @@ int main(int argc, char* argv[]) {
             exit(-1);
         }
         
+        // -threads caps all workers, image saves included, largest of the jobs.
+        unsigned maxThreads = commandPtr->threads;
+        for (Command* jobCommand : jobCommands) {
+            maxThreads = (maxThreads == 0 || jobCommand->threads == 0) ? 0 : std::max(maxThreads, jobCommand->threads);
+        }
+        Scheduler::limit(maxThreads);
+        
+        if (watchMode && (jobList.size() > 1 || commandPtr == &job->doPipelineF)) {
+            std::cerr << "-watch not supported with multiple -config jobs or -pipeline\n";
+            exit(-1);
+        }
+        
+        CmdMultiF doMultiF(&jobList.front()->imageCfg);
+        if (jobList.size() > 1) {
+            if (commandPtr == &job->doNone) {
+                std::cerr << "Last -config job has no command\n";
+                optionErrCnt++;
+            }
+            jobCommands.push_back(commandPtr);
+            for (Command* jobCommand : jobCommands) {
+                doMultiF.addJob(jobCommand);
+            }
+            commandPtr = &doMultiF;
+        }
+        
         if (commandPtr->begin(fileDirList)) {
             time_t startT;
+            double startSec = RunStats::now();
             showTitle(argv[0]);
             std::cerr << "Start " << currentDateTime(startT) << std::endl;
 
+            size_t filesFound = 0;
+            std::vector<size_t> scanCounts;
             if (patternErrCnt == 0 && optionErrCnt == 0 && fileDirList.size() != 0) {
                 if (fileDirList.size() == 1 && fileDirList[0] == "-") {
                     lstring filePath;
                     while (std::getline(std::cin, filePath)) {
-                        // size_t filesChecked = 
-                        InspectFiles(*commandPtr, filePath, 0);
+                        filesFound += InspectFiles(*commandPtr, filePath, 0, scanCounts);
                         // std::cerr << "\n  Files Checked=" << filesChecked << std::endl;
                     }
                 } else {
                     for (const lstring& filePath : fileDirList) {
-                        // size_t filesChecked = 
-                        InspectFiles(*commandPtr, filePath, 0);
+                        filesFound += InspectFiles(*commandPtr, filePath, 0, scanCounts);
                         // std::cerr << "\n  Files Checked=" << filesChecked << std::endl;
                     }
                 }
             }
 
+            Progress::start(filesFound);
             commandPtr->end();
+            Progress::stop();
             time_t endT;
             std::cerr << "\nEnd " << currentDateTime(endT) << std::endl;
-            std::cout << "Elapsed " << std::difftime(endT, startT) << " (sec)\n";
+            double elapsed = RunStats::now() - startSec;
+            if (RunStats::enabled) {
+                RunStats::print(std::cout, elapsed);
+                FMemory::print(std::cout);
+                if (!statsFile.empty()) {
+                    RunStats::saveJson(statsFile, elapsed);
+                }
+            } else {
+                std::cout << "Elapsed " << std::fixed << std::setprecision(3) << elapsed << " (sec)\n";
+                FMemory::printPeak(std::cout);
+            }
+            if (RunStats::tracing) {
+                RunStats::saveTrace(traceFile);
+            }
+            if (!FrameHash::path.empty()) {
+                FrameHash::save();
+            }
         }
 
         std::cerr << std::endl;
     }
 
+    Log::stop();
     return 0;
 }